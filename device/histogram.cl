@@ -37,16 +37,20 @@ channel  INPUT_DATA_TYPE pdata;
 
 
 
+// Streams a width x height region starting at offset, whose rows are pitch
+// elements apart, so a region of interest is read in place from the frame.
+// Contiguous data is the case height = 1, pitch = width.
 __kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
-read_data_kernel(__global INPUT_DATA_TYPE* vectorData, int data_length) {
+read_data_kernel(__global INPUT_DATA_TYPE* vectorData, int offset, int width, int height, int pitch) {
 
 
-	data_length = DATA_LENGTH;
-	//__attribute__((xcl_pipeline_loop))
-	#pragma ii 1
-	for (int i = 0; i < DATA_LENGTH; i++) {
-		//write_pipe_block(pdata, &vectorData[i]);
-		write_channel_intel(pdata, &vectorData[i]);
+	for (int y = 0; y < height; y++) {
+		//__attribute__((xcl_pipeline_loop))
+		#pragma ii 1
+		for (int x = 0; x < width; x++) {
+			//write_pipe_block(pdata, &vectorData[i]);
+			write_channel_intel(pdata, vectorData[offset + y*pitch + x]);
+		}
 	}
 
 }
@@ -54,10 +58,13 @@ read_data_kernel(__global INPUT_DATA_TYPE* vectorData, int data_length) {
 
 
 
+// Besides the histogram, stats receives STATS_WORDS moments of the data:
+// count, min, max, sum and sum of squares. They are reduced from the local
+// histogram once the stream has been consumed, exact for 8-bit data and
+// without a second pass over it.
 __kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
-compute_data_histogram_kernel(int data_length, int bin_size, __global BIN_DATA_TYPE *hist) {
+compute_data_histogram_kernel(int data_length, int bin_size, __global BIN_DATA_TYPE *hist, __global long *stats) {
 
-	data_length = DATA_LENGTH;
 	bin_size = BIN_SIZE;
 
 	local BIN_DATA_TYPE  hist_local[BIN_SIZE];
@@ -86,7 +93,511 @@ compute_data_histogram_kernel(int data_length, int bin_size, __global BIN_DATA_T
 
 	async_work_group_copy(hist, hist_local, BIN_SIZE, 0);
 
+
+	long count = 0;
+	long sum   = 0;
+	long sumsq = 0;
+	int  min_1 = -1;
+	int  max_1 = -1;
+
+	#pragma ii 1
+	for (int i = 0; i < BIN_SIZE; i++) {
+		long c = hist_local[i];
+		count += c;
+		sum   += c*i;
+		sumsq += c*i*i;
+		if (c != 0) {
+			min_1 = (min_1 < 0) ? i : min_1;
+			max_1 = i;
+		}
+	}
+
+	stats[0] = count;
+	stats[1] = (min_1 < 0) ? 0 : min_1;
+	stats[2] = (max_1 < 0) ? 0 : max_1;
+	stats[3] = sum;
+	stats[4] = sumsq;
+
+}
+
+
+
+
+channel  uchar2 ppair;
+
+
+
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+read_pair_kernel(__global INPUT_DATA_TYPE* vectorA, __global INPUT_DATA_TYPE* vectorB, int data_length) {
+
+	#pragma ii 1
+	for (int i = 0; i < data_length; i++) {
+		uchar2 pair;
+		pair.x = vectorA[i] >> (8 - JOINT_BIN_BITS);
+		pair.y = vectorB[i] >> (8 - JOINT_BIN_BITS);
+		write_channel_intel(ppair, pair);
+	}
+
+}
+
+
+
+
+// Joint histogram of (A, B) pairs, quantised to JOINT_BIN_SIZE levels each,
+// with a fused entropy reduction. joint_local takes JOINT_BIN_SIZE^2 counters
+// of on-chip memory, which is what JOINT_BIN_BITS trades against.
+// sums receives the total and the fixed-point (JOINT_LOG_SHIFT fractional
+// bits) sums of c*log2(c) over the A marginal, the B marginal and the joint
+// bins; the host turns them into entropies in double. Each log2 term is
+// rounded (it is taken in float, and (float)c itself rounds above 2^24),
+// only the total and the accumulation of the terms are exact.
+// The joint histogram itself is only copied out when write_joint is set.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+compute_joint_histogram_kernel(int data_length, int write_joint, __global BIN_DATA_TYPE *joint, __global long *sums) {
+
+	local BIN_DATA_TYPE  joint_local[JOINT_BIN_SIZE*JOINT_BIN_SIZE];
+	local BIN_DATA_TYPE  col_local[JOINT_BIN_SIZE];
+
+
+	for (int i = 0; i < JOINT_BIN_SIZE*JOINT_BIN_SIZE; i++) {
+		joint_local[i] = 0;
+	}
+	for (int i = 0; i < JOINT_BIN_SIZE; i++) {
+		col_local[i] = 0;
+	}
+
+
+	#pragma ii 1
+	for (int i = 0; i < data_length; i++) {
+
+		uchar2 pair = read_channel_intel(ppair);
+
+		joint_local[(unsigned int)pair.x*JOINT_BIN_SIZE + (unsigned int)pair.y]++;
+	}
+
+
+	long s_a  = 0;
+	long s_b  = 0;
+	long s_ab = 0;
+	long total = 0;
+
+	for (int a = 0; a < JOINT_BIN_SIZE; a++) {
+		BIN_DATA_TYPE row_sum = 0;
+		for (int b = 0; b < JOINT_BIN_SIZE; b++) {
+			BIN_DATA_TYPE c = joint_local[a*JOINT_BIN_SIZE + b];
+			row_sum      += c;
+			col_local[b] += c;
+			if (c > 1) {
+				s_ab += (long)c*(long)(log2((float)c)*(1 << JOINT_LOG_SHIFT) + 0.5f);
+			}
+		}
+		if (row_sum > 1) {
+			s_a += (long)row_sum*(long)(log2((float)row_sum)*(1 << JOINT_LOG_SHIFT) + 0.5f);
+		}
+		total += row_sum;
+	}
+	for (int b = 0; b < JOINT_BIN_SIZE; b++) {
+		BIN_DATA_TYPE c = col_local[b];
+		if (c > 1) {
+			s_b += (long)c*(long)(log2((float)c)*(1 << JOINT_LOG_SHIFT) + 0.5f);
+		}
+	}
+
+	sums[0] = total;
+	sums[1] = s_a;
+	sums[2] = s_b;
+	sums[3] = s_ab;
+
+	if (write_joint) {
+		async_work_group_copy(joint, joint_local, JOINT_BIN_SIZE*JOINT_BIN_SIZE, 0);
+	}
+
 }
 
 
 
+
+channel  uchar4 ppixel;
+
+
+
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+read_pixel_kernel(__global uchar4* vectorPixels, int num_pixels) {
+
+	#pragma ii 1
+	for (int i = 0; i < num_pixels; i++) {
+		write_channel_intel(ppixel, vectorPixels[i]);
+	}
+
+}
+
+
+
+
+// One histogram per channel of interleaved RGBA pixels, each channel in its
+// own local array so that the four updates of a pixel do not share a port.
+// hist receives 4 x BIN_SIZE bins, channel by channel.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+compute_multichannel_histogram_kernel(int num_pixels, __global BIN_DATA_TYPE *hist) {
+
+	local BIN_DATA_TYPE  hist_r[BIN_SIZE];
+	local BIN_DATA_TYPE  hist_g[BIN_SIZE];
+	local BIN_DATA_TYPE  hist_b[BIN_SIZE];
+	local BIN_DATA_TYPE  hist_a[BIN_SIZE];
+
+
+	for (int i = 0; i < BIN_SIZE; i++) {
+		hist_r[i] = 0;
+		hist_g[i] = 0;
+		hist_b[i] = 0;
+		hist_a[i] = 0;
+	}
+
+
+	#pragma ii 1
+	for (int i = 0; i < num_pixels; i++) {
+
+		uchar4 pixel = read_channel_intel(ppixel);
+
+		hist_r[(unsigned int)pixel.x]++;
+		hist_g[(unsigned int)pixel.y]++;
+		hist_b[(unsigned int)pixel.z]++;
+		hist_a[(unsigned int)pixel.w]++;
+	}
+
+	async_work_group_copy(hist + 0*BIN_SIZE, hist_r, BIN_SIZE, 0);
+	async_work_group_copy(hist + 1*BIN_SIZE, hist_g, BIN_SIZE, 0);
+	async_work_group_copy(hist + 2*BIN_SIZE, hist_b, BIN_SIZE, 0);
+	async_work_group_copy(hist + 3*BIN_SIZE, hist_a, BIN_SIZE, 0);
+
+}
+
+
+
+
+// Chained second pass of histogram equalisation: builds the LUT from the
+// histogram left in device memory by compute_data_histogram_kernel and
+// remaps the input that is still resident in the device buffer.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+equalize_data_kernel(__global INPUT_DATA_TYPE* vectorData, __global BIN_DATA_TYPE *hist, __global INPUT_DATA_TYPE* vectorOut, int data_length) {
+
+	local INPUT_DATA_TYPE  lut_local[BIN_SIZE];
+	local BIN_DATA_TYPE    cdf_local[BIN_SIZE];
+
+
+	BIN_DATA_TYPE running = 0;
+	BIN_DATA_TYPE cdf_min = 0;
+	for (int i = 0; i < BIN_SIZE; i++) {
+		running += hist[i];
+		cdf_local[i] = running;
+		if (cdf_min == 0) {
+			cdf_min = running;
+		}
+	}
+
+	float scale = (running > cdf_min) ? (float)(BIN_SIZE-1)/(float)(running - cdf_min) : 0.0f;
+	for (int i = 0; i < BIN_SIZE; i++) {
+		if (running == cdf_min) {
+			lut_local[i] = (INPUT_DATA_TYPE)i;
+		} else {
+			lut_local[i] = (cdf_local[i] > cdf_min) ? (INPUT_DATA_TYPE)((cdf_local[i] - cdf_min)*scale + 0.5f) : 0;
+		}
+	}
+
+
+	#pragma ii 1
+	for (int i = 0; i < data_length; i++) {
+		vectorOut[i] = lut_local[(unsigned int)vectorData[i]];
+	}
+
+}
+
+
+
+
+channel  INPUT_DATA_TYPE ptile;
+
+
+
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+read_image_kernel(__global INPUT_DATA_TYPE* vectorImage, int width, int height, int pitch) {
+
+	for (int y = 0; y < height; y++) {
+		#pragma ii 1
+		for (int x = 0; x < width; x++) {
+			write_channel_intel(ptile, vectorImage[y*pitch + x]);
+		}
+	}
+
+}
+
+
+
+
+// All tile histograms of a tiles_x x tiles_y grid in one pass. One band of
+// tiles (a tile row) is accumulated locally and flushed when the stream
+// crosses into the next band; tiles_x must not exceed TILED_MAX_TILES_X.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+compute_tiled_histogram_kernel(int width, int height, int tiles_x, int tiles_y, __global BIN_DATA_TYPE *hist) {
+
+	local BIN_DATA_TYPE  hist_local[TILED_MAX_TILES_X*BIN_SIZE];
+
+
+	for (int i = 0; i < TILED_MAX_TILES_X*BIN_SIZE; i++) {
+		hist_local[i] = 0;
+	}
+
+
+	int ty = 0;
+	int y_next = height/tiles_y;
+
+	for (int y = 0; y < height; y++) {
+
+		if (y == y_next) {
+			for (int i = 0; i < tiles_x*BIN_SIZE; i++) {
+				hist[ty*tiles_x*BIN_SIZE + i] = hist_local[i];
+				hist_local[i] = 0;
+			}
+			ty++;
+			y_next = (ty+1)*height/tiles_y;
+		}
+
+		int tx = 0;
+		int x_next = width/tiles_x;
+
+		#pragma ii 1
+		for (int x = 0; x < width; x++) {
+			if (x == x_next) {
+				tx++;
+				x_next = (tx+1)*width/tiles_x;
+			}
+
+			INPUT_DATA_TYPE d_1 = read_channel_intel(ptile);
+
+			hist_local[tx*BIN_SIZE + (unsigned int)d_1]++;
+		}
+	}
+
+	for (int i = 0; i < tiles_x*BIN_SIZE; i++) {
+		hist[ty*tiles_x*BIN_SIZE + i] = hist_local[i];
+	}
+
+}
+
+
+
+
+// Filtered stream: x = value, y = 1 on the final (empty) token.
+channel  uchar2 pmasked;
+
+
+
+// Sends only the elements with (use_mask == 0 || mask[i] != 0) and
+// lo <= data[i] <= hi; rejected elements never reach the channel.
+// mask is not read when use_mask is 0.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+read_masked_data_kernel(__global INPUT_DATA_TYPE* vectorData, __global unsigned char* vectorMask, int use_mask,
+                        int lo, int hi, int data_length) {
+
+	// a negative bound would wrap in the unsigned compares: lo is clamped
+	// to 0, and hi < 0 keeps nothing
+	unsigned int lo_1 = lo < 0 ? 0 : (unsigned int)lo;
+	unsigned int hi_1 = (unsigned int)hi;
+	bool in_range = hi >= 0;
+
+	#pragma ii 1
+	for (int i = 0; i < data_length; i++) {
+		INPUT_DATA_TYPE d_1 = vectorData[i];
+		bool keep = in_range && ((unsigned int)d_1 >= lo_1) && ((unsigned int)d_1 <= hi_1);
+		if (use_mask) {
+			keep = keep && (vectorMask[i] != 0);
+		}
+		if (keep) {
+			uchar2 token;
+			token.x = d_1;
+			token.y = 0;
+			write_channel_intel(pmasked, token);
+		}
+	}
+
+	uchar2 last;
+	last.x = 0;
+	last.y = 1;
+	write_channel_intel(pmasked, last);
+
+}
+
+
+
+
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+compute_masked_histogram_kernel(__global BIN_DATA_TYPE *hist) {
+
+	local BIN_DATA_TYPE  hist_local[BIN_SIZE];
+
+
+	for (int i = 0; i < BIN_SIZE; i++) {
+		hist_local[i] = 0;
+	}
+
+
+	bool done = false;
+	#pragma ii 1
+	while (!done) {
+
+		uchar2 token = read_channel_intel(pmasked);
+
+		if (token.y) {
+			done = true;
+		} else {
+			hist_local[(unsigned int)token.x]++;
+		}
+	}
+
+	async_work_group_copy(hist, hist_local, BIN_SIZE, 0);
+
+}
+
+
+
+
+channel  uint pkey;
+
+
+
+// Streams num_words 32-bit key words; 64-bit keys are sent as two words,
+// low word first.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+read_key_kernel(__global uint* vectorKeys, int num_words) {
+
+	#pragma ii 1
+	for (int i = 0; i < num_words; i++) {
+		write_channel_intel(pkey, vectorKeys[i]);
+	}
+
+}
+
+
+
+
+// All byte-digit histograms of the keys in one pass, the first phase of a
+// radix sort. Every digit has its own local array, always indexed by name,
+// so the four bytes of a word update four independent memories in the same
+// cycle; with words_per_key = 2 the high word of a 64-bit key goes to
+// digits 4..7. hist receives 4*words_per_key x BIN_SIZE bins, digit d at
+// d*BIN_SIZE.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+compute_digit_histogram_kernel(int num_words, int words_per_key, __global BIN_DATA_TYPE *hist) {
+
+	local BIN_DATA_TYPE  digit_0[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_1[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_2[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_3[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_4[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_5[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_6[BIN_SIZE];
+	local BIN_DATA_TYPE  digit_7[BIN_SIZE];
+
+
+	for (int i = 0; i < BIN_SIZE; i++) {
+		digit_0[i] = 0;
+		digit_1[i] = 0;
+		digit_2[i] = 0;
+		digit_3[i] = 0;
+		digit_4[i] = 0;
+		digit_5[i] = 0;
+		digit_6[i] = 0;
+		digit_7[i] = 0;
+	}
+
+
+	#pragma ii 1
+	for (int i = 0; i < num_words; i++) {
+
+		uint w = read_channel_intel(pkey);
+		uint b0 = w & 0xFF;
+		uint b1 = (w >> 8) & 0xFF;
+		uint b2 = (w >> 16) & 0xFF;
+		uint b3 = w >> 24;
+
+		if (words_per_key == 2 && (i & 1)) {
+			digit_4[b0]++;
+			digit_5[b1]++;
+			digit_6[b2]++;
+			digit_7[b3]++;
+		} else {
+			digit_0[b0]++;
+			digit_1[b1]++;
+			digit_2[b2]++;
+			digit_3[b3]++;
+		}
+	}
+
+	async_work_group_copy(&hist[0*BIN_SIZE], digit_0, BIN_SIZE, 0);
+	async_work_group_copy(&hist[1*BIN_SIZE], digit_1, BIN_SIZE, 0);
+	async_work_group_copy(&hist[2*BIN_SIZE], digit_2, BIN_SIZE, 0);
+	async_work_group_copy(&hist[3*BIN_SIZE], digit_3, BIN_SIZE, 0);
+	if (words_per_key == 2) {
+		async_work_group_copy(&hist[4*BIN_SIZE], digit_4, BIN_SIZE, 0);
+		async_work_group_copy(&hist[5*BIN_SIZE], digit_5, BIN_SIZE, 0);
+		async_work_group_copy(&hist[6*BIN_SIZE], digit_6, BIN_SIZE, 0);
+		async_work_group_copy(&hist[7*BIN_SIZE], digit_7, BIN_SIZE, 0);
+	}
+
+}
+
+
+
+
+channel  ulong ppartkey;
+
+
+
+// Streams the keys of num_keys records, key_stride 64-bit words apart
+// (1 for plain keys, 2 for key/payload tuples).
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+read_partition_key_kernel(__global ulong* vectorKeys, int key_stride, int num_keys) {
+
+	#pragma ii 1
+	for (int i = 0; i < num_keys; i++) {
+		write_channel_intel(ppartkey, vectorKeys[(long)i*key_stride]);
+	}
+
+}
+
+
+
+
+// Partition histograms of num_chunks equal chunks of the keys, for the
+// host-side scatter of histogram_partition_scatter_*. Chunk c covers keys
+// [n*c/num_chunks, n*(c+1)/num_chunks); the partition of a key is the top
+// `bits` bits of its multiplicative hash, as in histogram_partition_of().
+// hist receives num_chunks x 2^bits bins.
+__kernel void __attribute__ ((reqd_work_group_size(1, 1, 1)))
+compute_partition_histogram_kernel(int num_keys, int num_chunks, int bits, __global BIN_DATA_TYPE *hist) {
+
+	local BIN_DATA_TYPE  part_local[PARTITION_MAX_BINS];
+	int num_bins = 1 << bits;
+
+
+	for (int c = 0; c < num_chunks; c++) {
+
+		for (int p = 0; p < num_bins; p++) {
+			part_local[p] = 0;
+		}
+
+		int begin = (int)((long)num_keys*c/num_chunks);
+		int end   = (int)((long)num_keys*(c + 1)/num_chunks);
+
+		#pragma ii 1
+		for (int i = begin; i < end; i++) {
+			ulong key = read_channel_intel(ppartkey);
+			part_local[(uint)((key*0x9E3779B97F4A7C15UL) >> (64 - bits))]++;
+		}
+
+		for (int p = 0; p < num_bins; p++) {
+			hist[c*num_bins + p] = part_local[p];
+		}
+	}
+
+}
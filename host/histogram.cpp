@@ -26,6 +26,8 @@ SOFTWARE.
 * blog: https://highlevel-synthesis.com/
 */
 #include "histogram.h"
+#include "histogram_cpu.h"
+#include "histogram_check.h"
 
 
 #include <stdio.h>
@@ -52,6 +54,8 @@ int main(int argc, char** argv) {
 
 	int data_size = DATA_LENGTH;
 	int bin_size = BIN_SIZE;
+	int data_offset = 0;	// h_Data is one contiguous row of data_size elements
+	int data_height = 1;
 
 	printf("From main: Hello Histogram Version:01 \n");
 	printf("From main: =====================\n");
@@ -84,6 +88,7 @@ int main(int argc, char** argv) {
 
     cl_mem d_Data;                         // device memory used for data
     cl_mem d_Histogram;                         // device memory used for mean
+    cl_mem d_Stats;                             // device memory used for the moments
 
 
     cl_mem_ext_ptr_t d_Data_ext;
@@ -309,9 +314,11 @@ int main(int argc, char** argv) {
     // Create the input and output arrays in device memory for our calculation
 	//
 	d_Data = clCreateBuffer(context,  CL_MEM_READ_ONLY | CL_MEM_EXT_PTR_XILINX | CL_MEM_COPY_HOST_PTR,  sizeof(INPUT_DATA_TYPE) * data_size, &d_Data_ext, NULL);
-	d_Histogram = clCreateBuffer(context,  CL_MEM_WRITE_ONLY | CL_MEM_EXT_PTR_XILINX | CL_MEM_COPY_HOST_PTR, sizeof(BIN_DATA_TYPE) * bin_size, &d_Histogram_ext, NULL);
+	d_Histogram = clCreateBuffer(context,  CL_MEM_READ_WRITE | CL_MEM_EXT_PTR_XILINX | CL_MEM_COPY_HOST_PTR, sizeof(BIN_DATA_TYPE) * bin_size, &d_Histogram_ext, NULL);
 
-	if (!d_Data || !d_Histogram) {
+	d_Stats = clCreateBuffer(context,  CL_MEM_WRITE_ONLY, sizeof(cl_long) * STATS_WORDS, NULL, NULL);
+
+	if (!d_Data || !d_Histogram || !d_Stats) {
 		printf("Error: Failed to allocate device memory!\n");
 	    printf("Test failed\n");
 	    return EXIT_FAILURE;
@@ -335,7 +342,10 @@ int main(int argc, char** argv) {
 	start_app_time=getTimestamp();
 	err = 0;
 	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Data);
-	err  |= clSetKernelArg(read_kernel, 1, sizeof(int), &data_size);
+	err  |= clSetKernelArg(read_kernel, 1, sizeof(int), &data_offset);
+	err  |= clSetKernelArg(read_kernel, 2, sizeof(int), &data_size);
+	err  |= clSetKernelArg(read_kernel, 3, sizeof(int), &data_height);
+	err  |= clSetKernelArg(read_kernel, 4, sizeof(int), &data_size);
 	if (err != CL_SUCCESS) {
 		printf("Error: Failed to set kernel arguments! %d\n", err);
 	    printf("Test failed\n");
@@ -363,6 +373,7 @@ int main(int argc, char** argv) {
 	err   = clSetKernelArg(compute_histogram_kernel, 0, sizeof(int), &data_size);
 	err  |= clSetKernelArg(compute_histogram_kernel, 1, sizeof(int), &bin_size);
 	err  |= clSetKernelArg(compute_histogram_kernel, 2, sizeof(cl_mem), &d_Histogram);
+	err  |= clSetKernelArg(compute_histogram_kernel, 3, sizeof(cl_mem), &d_Stats);
 
     if (err != CL_SUCCESS) {
     	printf("Error: Failed to set reduce kernel arguments! %d\n", err);
@@ -412,7 +423,10 @@ int main(int argc, char** argv) {
 	start_app_time=getTimestamp();
 	err = 0;
 	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Data);
-	err  |= clSetKernelArg(read_kernel, 1, sizeof(int), &data_size);
+	err  |= clSetKernelArg(read_kernel, 1, sizeof(int), &data_offset);
+	err  |= clSetKernelArg(read_kernel, 2, sizeof(int), &data_size);
+	err  |= clSetKernelArg(read_kernel, 3, sizeof(int), &data_height);
+	err  |= clSetKernelArg(read_kernel, 4, sizeof(int), &data_size);
 	if (err != CL_SUCCESS) {
 		printf("Error: Failed to set kernel arguments! %d\n", err);
 	    printf("Test failed\n");
@@ -440,6 +454,7 @@ int main(int argc, char** argv) {
 	err   = clSetKernelArg(compute_histogram_kernel, 0, sizeof(int), &data_size);
 	err  |= clSetKernelArg(compute_histogram_kernel, 1, sizeof(int), &bin_size);
 	err  |= clSetKernelArg(compute_histogram_kernel, 2, sizeof(cl_mem), &d_Histogram);
+	err  |= clSetKernelArg(compute_histogram_kernel, 3, sizeof(cl_mem), &d_Stats);
 
     if (err != CL_SUCCESS) {
     	printf("Error: Failed to set reduce kernel arguments! %d\n", err);
@@ -484,6 +499,15 @@ int main(int argc, char** argv) {
    	printf("Second App total execution time  %.6lf ms elapsed\n", app_total_time);
 
 
+	cl_long h_Stats[STATS_WORDS];
+	err = clEnqueueReadBuffer( commands, d_Stats, CL_TRUE, 0, sizeof(cl_long) * STATS_WORDS, h_Stats, 0, NULL, NULL);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to read stats array! %d\n", err);
+	    printf("Test failed\n");
+	    return EXIT_FAILURE;
+	}
+
+
 	clGetEventProfilingInfo(read_kernel_event, CL_PROFILING_COMMAND_START,
 		sizeof(time_start), &time_start, NULL);
 	clGetEventProfilingInfo(read_kernel_event, CL_PROFILING_COMMAND_END,
@@ -509,6 +533,7 @@ int main(int argc, char** argv) {
 
 	clReleaseMemObject(d_Data);
 	clReleaseMemObject(d_Histogram);
+	clReleaseMemObject(d_Stats);
 	clReleaseKernel(read_kernel);
 	clReleaseKernel(compute_histogram_kernel);
 	clReleaseEvent(transfer_c_event);
@@ -532,6 +557,27 @@ int main(int argc, char** argv) {
 	    }
 	}
 
+    // moments from the kernel against the golden histogram's
+    int64_t stats_words[STATS_WORDS];
+    for (int i = 0; i < STATS_WORDS; i++) {
+    	stats_words[i] = (int64_t)h_Stats[i];
+    }
+    histogram_stats_t hw_stats, gold_stats;
+    histogram_stats_from_sums(stats_words, &hw_stats);
+    histogram_stats_from_histogram(h_Histogram_golden, &gold_stats);
+    printf("Stats: count=%llu min=%.0f max=%.0f mean=%.6f variance=%.6f\n",
+    		(unsigned long long)hw_stats.count, hw_stats.min, hw_stats.max, hw_stats.mean,
+    		hw_stats.count ? hw_stats.m2/hw_stats.count : 0.0);
+    if (hw_stats.count != gold_stats.count || hw_stats.min != gold_stats.min || hw_stats.max != gold_stats.max ||
+    	hw_stats.sum != gold_stats.sum || hw_stats.sumsq != gold_stats.sumsq) {
+    	printf("Error in stats: golden count=%llu min=%.0f max=%.0f sum=%.0f sumsq=%.0f\n",
+    			(unsigned long long)gold_stats.count, gold_stats.min, gold_stats.max, gold_stats.sum, gold_stats.sumsq);
+    }
+
+    // the host engines against their naive references
+    int check_errors = histogram_check(h_Data, data_size);
+    printf("Host checks: %d errors\n", check_errors);
+
     printf("From main: Bye Histogram\n");
     printf("From main: ====================\n");
     return 0;
@@ -42,5 +42,22 @@ SOFTWARE.
 #define BIN_SIZE 256
 
 
+// compute_joint_histogram_kernel quantises both inputs to JOINT_BIN_BITS
+// bits; its local table holds JOINT_BIN_SIZE^2 BIN_DATA_TYPE counters
+// (16 KB for 6 bits, 256 KB for the full 8).
+#define JOINT_BIN_BITS 6
+#define JOINT_BIN_SIZE (1 << JOINT_BIN_BITS)
+// fractional bits of the fixed-point c*log2(c) sums of the joint kernel
+#define JOINT_LOG_SHIFT 20
+
+#define TILED_MAX_TILES_X 16
+
+#define PARTITION_MAX_BITS 12
+#define PARTITION_MAX_BINS (1 << PARTITION_MAX_BITS)
+
+// compute_data_histogram_kernel stats: count, min, max, sum, sum of squares
+#define STATS_WORDS 5
+
+
 
 #endif // __VECTOR_ADDITION_h__
@@ -0,0 +1,288 @@
+/* File: histogram_autorange.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_autorange.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_autorange.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+
+static int autorange_compare(const void *a, const void *b) {
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+
+// Quantile q of the sorted sample, linearly interpolated.
+static double autorange_quantile(const double *sorted, size_t m, double q) {
+	double pos = q*(double)(m - 1);
+	size_t i = (size_t)pos;
+	if (i + 1 >= m) {
+		return sorted[m - 1];
+	}
+	return sorted[i] + (pos - (double)i)*(sorted[i + 1] - sorted[i]);
+}
+
+
+// Bin width from the rule; the range is already set.
+static double autorange_width(int rule, const double *sorted, size_t m, size_t n, double range) {
+	double nn = (double)(n > 1 ? n : 2);
+	double bins = 0;
+	double width = 0;
+
+	if (rule == AUTORANGE_SCOTT) {
+		double mean = 0;
+		double m2 = 0;
+		for (size_t i = 0; i < m; i++) {
+			double d = sorted[i] - mean;
+			mean += d/(double)(i + 1);
+			m2 += d*(sorted[i] - mean);
+		}
+		width = 3.49*sqrt(m2/(double)m)*pow(nn, -1.0/3.0);
+	} else if (rule == AUTORANGE_FREEDMAN_DIACONIS) {
+		double iqr = autorange_quantile(sorted, m, 0.75) - autorange_quantile(sorted, m, 0.25);
+		width = 2.0*iqr*pow(nn, -1.0/3.0);
+	} else if (rule == AUTORANGE_SQRT) {
+		bins = ceil(sqrt(nn));
+	} else {
+		bins = ceil(log2(nn)) + 1;
+	}
+
+	// Sturges when a spread based rule degenerates (e.g. IQR of 0)
+	if (bins == 0 && !(width > 0)) {
+		bins = ceil(log2(nn)) + 1;
+	}
+	if (bins > 0) {
+		width = range/bins;
+	}
+	if (!(width > 0) || !(width <= range)) {
+		width = range;
+	}
+	if (range/width > AUTORANGE_MAX_BINS) {
+		width = range/AUTORANGE_MAX_BINS;
+	}
+	return width;
+}
+
+
+// Sets num_bins and hi for [lo, lo + num_bins*width) and clears the counts.
+// lo, range and width are finite and width > 0.
+static int autorange_layout(histogram_autorange_t *h, double lo, double range, double width) {
+	double bins = ceil(range/width);
+	int num_bins = bins < 1 ? 1 : (bins < AUTORANGE_MAX_BINS ? (int)bins : AUTORANGE_MAX_BINS);
+	free(h->counts);
+	h->counts = (uint64_t *)calloc(num_bins, sizeof(uint64_t));
+	if (!h->counts) {
+		return -2;
+	}
+	h->num_bins  = num_bins;
+	h->lo        = lo;
+	h->width     = width;
+	h->hi        = lo + num_bins*width;
+	h->underflow = 0;
+	h->overflow  = 0;
+	h->nans      = 0;
+	h->infinities = 0;
+	return 0;
+}
+
+
+// One pass: per-thread counts with underflow (slot 0) and overflow
+// (slot num_bins + 1) bins, NaNs and infinities (the two slots after),
+// plus the exact finite extremes.
+template <typename T>
+static int autorange_pass(const T *Data, size_t n, histogram_autorange_t *h) {
+	int num_threads = histogram_cpu_threads();
+	int slots = h->num_bins + 2;
+	uint64_t *partial = (uint64_t *)calloc((size_t)num_threads*(slots + 2), sizeof(uint64_t));
+	double *extremes = (double *)malloc(sizeof(double)*2*num_threads);
+	if (!partial || !extremes) {
+		free(partial);
+		free(extremes);
+		return -2;
+	}
+	double lo = h->lo;
+	double inv_width = 1.0/h->width;
+	int num_bins = h->num_bins;
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(n, &begin, &end);
+		uint64_t *c = &partial[(size_t)tid*(slots + 2)];
+		double vmin = DBL_MAX;
+		double vmax = -DBL_MAX;
+		for (size_t i = begin; i < end; i++) {
+			double x = (double)Data[i];
+			if (x != x) {
+				c[slots]++;		// NaN
+				continue;
+			}
+			if (x < -DBL_MAX || x > DBL_MAX) {
+				c[slots + 1]++;
+				c[x < 0 ? 0 : num_bins + 1]++;
+				continue;
+			}
+			vmin = x < vmin ? x : vmin;
+			vmax = x > vmax ? x : vmax;
+			// NaN positions (inf*0) can never reach the cast
+			double pos = (x - lo)*inv_width;
+			int slot = pos < 0 ? 0 : (!(pos < num_bins) ? num_bins + 1 : (int)pos + 1);
+			c[slot]++;
+		}
+		extremes[2*tid]     = vmin;
+		extremes[2*tid + 1] = vmax;
+	}
+
+	h->min = DBL_MAX;
+	h->max = -DBL_MAX;
+	for (int t = 0; t < num_threads; t++) {
+		const uint64_t *c = &partial[(size_t)t*(slots + 2)];
+		h->underflow += c[0];
+		for (int b = 0; b < num_bins; b++) {
+			h->counts[b] += c[b + 1];
+		}
+		h->overflow += c[num_bins + 1];
+		h->nans     += c[slots];
+		h->infinities += c[slots + 1];
+		h->min = extremes[2*t] < h->min ? extremes[2*t] : h->min;
+		h->max = extremes[2*t + 1] > h->max ? extremes[2*t + 1] : h->max;
+	}
+	h->passes++;
+
+	free(partial);
+	free(extremes);
+	return 0;
+}
+
+
+template <typename T>
+static int autorange(const T *Data, size_t n, int rule, histogram_autorange_t *h) {
+	memset(h, 0, sizeof(*h));
+	if (rule < AUTORANGE_STURGES || rule > AUTORANGE_FREEDMAN_DIACONIS) {
+		return -1;
+	}
+
+	// strided sample, NaNs and infinities skipped
+	size_t m = n < AUTORANGE_SAMPLE_SIZE ? n : AUTORANGE_SAMPLE_SIZE;
+	double *sample = (double *)malloc(sizeof(double)*(m ? m : 1));
+	if (!sample) {
+		return -2;
+	}
+	size_t taken = 0;
+	for (size_t s = 0; s < m; s++) {
+		double x = (double)Data[(size_t)((double)s*(double)n/(double)m)];
+		if (x >= -DBL_MAX && x <= DBL_MAX) {
+			sample[taken++] = x;
+		}
+	}
+	qsort(sample, taken, sizeof(double), autorange_compare);
+
+	double lo = 0.0;
+	double range = 1.0;
+	if (taken > 0) {
+		double q_lo = autorange_quantile(sample, taken, AUTORANGE_GUARD);
+		double q_hi = autorange_quantile(sample, taken, 1.0 - AUTORANGE_GUARD);
+		double margin = AUTORANGE_MARGIN*(q_hi - q_lo);
+		lo = q_lo - margin;
+		range = (q_hi + margin) - lo;
+		if (!(range <= DBL_MAX)) {
+			// finite doubles more than DBL_MAX apart
+			lo = q_lo;
+			range = DBL_MAX;
+		}
+		if (!(range > 0)) {
+			// constant sample: one unit-wide bin around it
+			lo = q_lo - 0.5;
+			range = 1.0;
+		}
+	}
+	double width = taken > 1 ? autorange_width(rule, sample, taken, n, range) : range;
+	free(sample);
+
+	int err = autorange_layout(h, lo, range, width);
+	if (err == 0) {
+		err = autorange_pass(Data, n, h);
+	}
+	if (err != 0) {
+		return err;
+	}
+
+	// refine: the sample missed too much of the distribution; keep the
+	// width where possible and stretch the range to the exact extremes.
+	// Infinities are outside any range and do not count here.
+	uint64_t finite = n - h->nans - h->infinities;
+	uint64_t outside = h->underflow + h->overflow - h->infinities;
+	double vmin = h->min;
+	double extent = h->max - vmin;
+	if (finite == 0) {
+		h->min = 0;
+		h->max = 0;
+	} else if ((double)outside > AUTORANGE_MAX_OUTSIDE*(double)finite && extent <= DBL_MAX) {
+		if (!(extent > 0)) {
+			vmin -= 0.5;
+			extent = 1.0;
+		}
+		if (extent/width > AUTORANGE_MAX_BINS) {
+			width = extent/AUTORANGE_MAX_BINS;
+		}
+		// the maximum has to land inside the last bin, also after rounding
+		int num_bins = (int)ceil(extent/width);
+		while (num_bins > 0 && extent*(1.0/width) >= num_bins) {
+			if (num_bins < AUTORANGE_MAX_BINS) {
+				num_bins++;
+			} else {
+				width = nextafter(width, DBL_MAX);
+			}
+		}
+		int passes = h->passes;
+		err = autorange_layout(h, vmin, num_bins*width, width);
+		if (err == 0) {
+			h->passes = passes;
+			err = autorange_pass(Data, n, h);
+		}
+	}
+	return err;
+}
+
+
+int histogram_autorange_float(const float *Data, size_t n, int rule, histogram_autorange_t *h) {
+	return autorange(Data, n, rule, h);
+}
+
+
+int histogram_autorange_double(const double *Data, size_t n, int rule, histogram_autorange_t *h) {
+	return autorange(Data, n, rule, h);
+}
+
+
+void histogram_autorange_release(histogram_autorange_t *h) {
+	free(h->counts);
+	h->counts = NULL;
+}
@@ -0,0 +1,82 @@
+/* File: histogram_autorange.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_autorange.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_AUTORANGE_h__
+#define __HISTOGRAM_AUTORANGE_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Values looked at to estimate the range, taken at a fixed stride.
+#define AUTORANGE_SAMPLE_SIZE 16384
+// The range spans the sample quantiles AUTORANGE_GUARD and 1 - AUTORANGE_GUARD,
+// widened by AUTORANGE_MARGIN of its width on each side, so a few outliers
+// in the sample cannot stretch it.
+#define AUTORANGE_GUARD  0.001
+#define AUTORANGE_MARGIN 0.05
+// A second pass is made only if more than this fraction of the finite
+// values falls into the underflow and overflow bins.
+#define AUTORANGE_MAX_OUTSIDE 0.01
+#define AUTORANGE_MAX_BINS 65536
+
+// Bin-count rules, evaluated on the sample for the full n.
+#define AUTORANGE_STURGES          0   // log2(n) + 1 bins
+#define AUTORANGE_SQRT             1   // sqrt(n) bins
+#define AUTORANGE_SCOTT            2   // width 3.49 sigma n^(-1/3)
+#define AUTORANGE_FREEDMAN_DIACONIS 3  // width 2 IQR n^(-1/3)
+
+// Histogram of float data with unknown range. Bin b covers
+// [lo + b*width, lo + (b+1)*width); values below lo and at or above hi go to
+// the underflow and overflow counts, NaNs are counted apart. Infinities are
+// counted in underflow/overflow, and also in `infinities`, but never widen
+// the range.
+typedef struct {
+	int       num_bins;
+	double    lo;
+	double    hi;
+	double    width;
+	uint64_t *counts;
+	uint64_t  underflow;
+	uint64_t  overflow;
+	uint64_t  nans;
+	uint64_t  infinities;  // +-inf, included in underflow/overflow
+	double    min;         // exact extremes of the finite values
+	double    max;
+	int       passes;      // passes over the data: 1, or 2 after a refine
+} histogram_autorange_t;
+
+// Estimates the range from a strided sample, picks the bin count with
+// `rule`, and histograms the data in one pass. Only if more than
+// AUTORANGE_MAX_OUTSIDE of it lands outside the estimated range is the
+// range widened to the exact extremes (tracked by that pass) and the data
+// histogrammed again. The result is released with histogram_autorange_release.
+// Returns 0, -1 for an unknown rule, -2 if allocation fails.
+int histogram_autorange_float(const float *Data, size_t n, int rule, histogram_autorange_t *h);
+int histogram_autorange_double(const double *Data, size_t n, int rule, histogram_autorange_t *h);
+void histogram_autorange_release(histogram_autorange_t *h);
+
+#endif // __HISTOGRAM_AUTORANGE_h__
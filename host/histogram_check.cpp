@@ -0,0 +1,1914 @@
+/* File: histogram_check.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_check.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_check.h"
+#include "histogram_cpu.h"
+#include "histogram_edges.h"
+#include "histogram_weighted.h"
+#include "histogram_joint.h"
+#include "histogram_multichannel.h"
+#include "histogram_equalize.h"
+#include "histogram_window.h"
+#include "histogram_tiled.h"
+#include "histogram_integral.h"
+#include "histogram_hash.h"
+#include "histogram_grouped.h"
+#include "histogram_sparse.h"
+#include "histogram_topk.h"
+#include "histogram_hdr.h"
+#include "histogram_query.h"
+#include "histogram_distance.h"
+#include "histogram_entropy.h"
+#include "histogram_stream.h"
+#include "histogram_ngram.h"
+#include "histogram_radix.h"
+#include "histogram_select.h"
+#include "histogram_partition.h"
+#include "histogram_autorange.h"
+#include "histogram_sample.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+#include <unistd.h>
+
+
+// Input bytes of the checks: Data mixed with a fixed pseudo-random sequence,
+// so that constant data still spreads over all bins.
+static unsigned char *check_bytes(const INPUT_DATA_TYPE *Data, int n) {
+	unsigned char *bytes = (unsigned char *)malloc(n > 0 ? n : 1);
+	if (!bytes) {
+		return NULL;
+	}
+	unsigned int x = 2463534242u;
+	for (int i = 0; i < n; i++) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		bytes[i] = (unsigned char)((unsigned int)Data[i] + (x >> 24));
+	}
+	return bytes;
+}
+
+
+static int check_alloc_failed(const char *engine) {
+	printf("Error in %s: allocation failed\n", engine);
+	return 1;
+}
+
+
+static int check_bins(const char *engine, const BIN_DATA_TYPE *gold, const BIN_DATA_TYPE *hw, int bins) {
+	int errors = 0;
+	for (int i = 0; i < bins; i++) {
+		if (gold[i] != hw[i]) {
+			printf("Error in %s at element %d golden= %d, hw=%d\n", engine, i, gold[i], hw[i]);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+
+static int check_compare_i64(const void *a, const void *b) {
+	int64_t x = *(const int64_t *)a;
+	int64_t y = *(const int64_t *)b;
+	return (x > y) - (x < y);
+}
+
+
+static int check_compare_u64(const void *a, const void *b) {
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+
+// Irregular edges; the values hit the edges exactly, fall outside them,
+// and include NaN.
+static int check_edges(const unsigned char *bytes, int n) {
+	const float edges[] = {0.0f, 1.0f, 2.5f, 3.0f, 10.0f, 64.0f, 64.5f, 100.0f, 200.0f, 250.0f};
+	const int num_edges = sizeof(edges)/sizeof(edges[0]);
+	BIN_DATA_TYPE gold[num_edges - 1];
+	BIN_DATA_TYPE hw[num_edges - 1];
+	histogram_edges_t edges_set;
+	float *values = (float *)malloc(sizeof(float)*(n > 0 ? n : 1));
+	if (!values || histogram_edges_create(&edges_set, edges, num_edges) != 0) {
+		free(values);
+		return check_alloc_failed("edges");
+	}
+
+	memset(gold, 0, sizeof(gold));
+	for (int i = 0; i < n; i++) {
+		float x = (bytes[i] == 255) ? NAN : (float)bytes[i] + ((bytes[i] & 1) ? 0.5f : 0.0f);
+		values[i] = x;
+		for (int b = 0; b < num_edges - 1; b++) {
+			if (x >= edges[b] && (x < edges[b + 1] || (b == num_edges - 2 && x == edges[b + 1]))) {
+				gold[b]++;
+				break;
+			}
+		}
+	}
+
+	int errors;
+	if (histogram_edges_compute(&edges_set, values, n, hw) != 0) {
+		errors = check_alloc_failed("edges");
+	} else {
+		errors = check_bins("edges", gold, hw, num_edges - 1);
+	}
+	histogram_edges_release(&edges_set);
+	free(values);
+	return errors;
+}
+
+
+// Dyadic weights (multiples of 1/1024) have exact bin sums, so both
+// accumulators must match bit for bit; weights of 0.1 are compared in
+// double against a long double reference.
+static int check_weighted(const unsigned char *bytes, int n) {
+	float *wf = (float *)malloc(sizeof(float)*(n > 0 ? n : 1));
+	double *wd = (double *)malloc(sizeof(double)*(n > 0 ? n : 1));
+	float *hf = (float *)malloc(sizeof(float)*BIN_SIZE);
+	double *hd = (double *)malloc(sizeof(double)*BIN_SIZE);
+	long double *gold = (long double *)calloc(BIN_SIZE, sizeof(long double));
+	int errors = 0;
+	if (!wf || !wd || !hf || !hd || !gold) {
+		errors = check_alloc_failed("weighted");
+		goto release;
+	}
+
+	for (int i = 0; i < n; i++) {
+		wf[i] = (float)(((unsigned int)i*7919u) & 1023)/1024.0f;
+		wd[i] = wf[i];
+		gold[bytes[i]] += wd[i];
+	}
+	if (histogram_weighted_float(bytes, wf, n, hf) != 0 || histogram_weighted_double(bytes, wd, n, hd) != 0) {
+		errors = check_alloc_failed("weighted");
+		goto release;
+	}
+	for (int b = 0; b < BIN_SIZE; b++) {
+		if ((long double)hf[b] != gold[b] || (long double)hd[b] != gold[b]) {
+			printf("Error in weighted at element %d golden= %.6Lf, float=%.6f, double=%.6f\n", b, gold[b], hf[b], hd[b]);
+			errors++;
+		}
+	}
+
+	memset(gold, 0, sizeof(long double)*BIN_SIZE);
+	for (int i = 0; i < n; i++) {
+		wd[i] = 0.1;
+		gold[bytes[i]] += (long double)0.1;
+	}
+	if (histogram_weighted_double(bytes, wd, n, hd) != 0) {
+		errors += check_alloc_failed("weighted");
+		goto release;
+	}
+	for (int b = 0; b < BIN_SIZE; b++) {
+		if (fabsl((long double)hd[b] - gold[b]) > 1e-15L*gold[b]) {
+			printf("Error in weighted at element %d golden= %.12Lf, double=%.12f\n", b, gold[b], hd[b]);
+			errors++;
+		}
+	}
+
+release:
+	free(wf);
+	free(wd);
+	free(hf);
+	free(hd);
+	free(gold);
+	return errors;
+}
+
+
+// A against B = A shifted by one element, at 64 and 256 levels for 8-bit
+// and 1024 levels for 16-bit pairs; the fused entropies must agree with
+// the ones of the golden joint histogram.
+static int check_joint(const unsigned char *bytes, int n) {
+	int m = n/2;
+	BIN_DATA_TYPE *gold = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*JOINT_MAX_BINS*JOINT_MAX_BINS);
+	BIN_DATA_TYPE *hw = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*JOINT_MAX_BINS*JOINT_MAX_BINS);
+	unsigned short *wide = (unsigned short *)malloc(sizeof(unsigned short)*(n > 0 ? n : 1));
+	int errors = 0;
+	if (!gold || !hw || !wide || n < 2) {
+		errors = (n < 2) ? 0 : check_alloc_failed("joint");
+		goto release;
+	}
+	for (int i = 0; i < m; i++) {
+		wide[i] = (unsigned short)(bytes[2*i] << 8 | bytes[2*i + 1]);
+	}
+
+	for (int bins = 64; bins <= JOINT_MAX_BINS; bins *= 4) {
+		int wide_data = (bins > 256);
+		int len = wide_data ? m - 1 : n - 1;
+		int shift = (wide_data ? 16 : 8) - (int)log2((double)bins);
+		memset(gold, 0, sizeof(BIN_DATA_TYPE)*bins*bins);
+		for (int i = 0; i < len; i++) {
+			int a = wide_data ? wide[i] : bytes[i];
+			int b = wide_data ? wide[i + 1] : bytes[i + 1];
+			gold[(a >> shift)*bins + (b >> shift)]++;
+		}
+
+		histogram_joint_info_t info, gold_info;
+		int err = wide_data ? histogram_joint_u16(wide, wide + 1, len, bins, hw)
+		                    : histogram_joint_u8(bytes, bytes + 1, len, bins, hw);
+		if (err == 0) {
+			err = wide_data ? histogram_joint_info_u16(wide, wide + 1, len, bins, &info)
+			                : histogram_joint_info_u8(bytes, bytes + 1, len, bins, &info);
+		}
+		if (err == 0) {
+			err = histogram_joint_entropy(gold, bins, &gold_info);
+		}
+		if (err != 0) {
+			errors += check_alloc_failed("joint");
+			break;
+		}
+		errors += check_bins("joint", gold, hw, bins*bins);
+		if (fabs(info.entropy_a - gold_info.entropy_a) > 1e-9 || fabs(info.entropy_b - gold_info.entropy_b) > 1e-9 ||
+		    fabs(info.entropy_ab - gold_info.entropy_ab) > 1e-9) {
+			printf("Error in joint info at %d bins golden= %f %f %f, hw=%f %f %f\n", bins,
+			       gold_info.entropy_a, gold_info.entropy_b, gold_info.entropy_ab, info.entropy_a, info.entropy_b, info.entropy_ab);
+			errors++;
+		}
+	}
+
+release:
+	free(gold);
+	free(hw);
+	free(wide);
+	return errors;
+}
+
+
+// The bytes read as RGB and as RGBA pixels.
+static int check_multichannel(const unsigned char *bytes, int n) {
+	BIN_DATA_TYPE gold[MULTICHANNEL_MAX_CHANNELS*BIN_SIZE];
+	BIN_DATA_TYPE hw[MULTICHANNEL_MAX_CHANNELS*BIN_SIZE];
+	int errors = 0;
+
+	for (int channels = 3; channels <= 4; channels++) {
+		int num_pixels = n/channels;
+		memset(gold, 0, sizeof(gold));
+		for (int i = 0; i < num_pixels*channels; i++) {
+			gold[(i % channels)*BIN_SIZE + bytes[i]]++;
+		}
+		if (histogram_multichannel(bytes, num_pixels, channels, hw) != 0) {
+			errors += check_alloc_failed("multichannel");
+			continue;
+		}
+		errors += check_bins("multichannel", gold, hw, channels*BIN_SIZE);
+	}
+	return errors;
+}
+
+
+// The LUT against exact integer rounding (either side of a tie), the full
+// pipeline against that LUT, and an in-place apply of a scrambling table
+// on an unaligned range.
+static int check_equalize(const unsigned char *bytes, int n) {
+	BIN_DATA_TYPE gold[BIN_SIZE];
+	BIN_DATA_TYPE hw[BIN_SIZE];
+	BIN_DATA_TYPE cdf[BIN_SIZE];
+	unsigned char lut[BIN_SIZE];
+	unsigned char *out = (unsigned char *)malloc(n > 0 ? n : 1);
+	int errors = 0;
+	if (!out) {
+		return check_alloc_failed("equalize");
+	}
+
+	memset(gold, 0, sizeof(gold));
+	for (int i = 0; i < n; i++) {
+		gold[bytes[i]]++;
+	}
+	histogram_equalize(bytes, out, n, hw);
+	errors += check_bins("equalize", gold, hw, BIN_SIZE);
+	histogram_equalize_lut(gold, cdf, lut);
+
+	int64_t running = 0;
+	int64_t cdf_min = 0;
+	for (int v = 0; v < BIN_SIZE; v++) {
+		running += gold[v];
+		cdf_min = cdf_min ? cdf_min : running;
+	}
+	int64_t range = running - cdf_min;
+	running = 0;
+	for (int v = 0; v < BIN_SIZE; v++) {
+		running += gold[v];
+		int64_t num = 2*(running > cdf_min ? running - cdf_min : 0)*(BIN_SIZE - 1);
+		int ref = range ? (int)((num + range)/(2*range)) : v;
+		int tie = range && (num % (2*range)) == range;
+		if (cdf[v] != running || (lut[v] != ref && !(tie && lut[v] == ref - 1))) {
+			printf("Error in equalize lut at element %d golden= %d, hw=%d\n", v, ref, lut[v]);
+			errors++;
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		if (out[i] != lut[bytes[i]]) {
+			printf("Error in equalize at element %d golden= %d, hw=%d\n", i, lut[bytes[i]], out[i]);
+			errors++;
+			break;
+		}
+	}
+
+	for (int v = 0; v < BIN_SIZE; v++) {
+		lut[v] = (unsigned char)(v*37 + 11);
+	}
+	memcpy(out, bytes, n);
+	if (n > 4) {
+		histogram_apply_lut(out + 1, out + 1, n - 4, lut);
+	}
+	for (int i = 0; i < n; i++) {
+		unsigned char ref = (i >= 1 && i < n - 3) ? lut[bytes[i]] : bytes[i];
+		if (n > 4 && out[i] != ref) {
+			printf("Error in apply_lut at element %d golden= %d, hw=%d\n", i, ref, out[i]);
+			errors++;
+			break;
+		}
+	}
+
+	free(out);
+	return errors;
+}
+
+
+// Pushes of assorted lengths, some longer than the window, over a stream
+// that alternates between the check bytes and stretches repeating with
+// the window period (the samples then equal the ones they evict). After
+// every push the bins, CDF, median and mode are compared with a recount
+// of the last `window` samples.
+#define CHECK_WINDOW 1000
+
+static int check_window(const unsigned char *bytes, int n) {
+	const int chunks[] = {1, 7, 100, 999, 1000, 2500, 333, 16, 48};
+	const int num_chunks = sizeof(chunks)/sizeof(chunks[0]);
+	int len = n < 200000 ? n : 200000;
+	unsigned char *stream = (unsigned char *)malloc(len > 0 ? len : 1);
+	histogram_window_t w;
+	if (!stream || histogram_window_create(&w, CHECK_WINDOW) != 0) {
+		free(stream);
+		return check_alloc_failed("window");
+	}
+	for (int i = 0; i < len; i++) {
+		stream[i] = ((i/20000) & 1) ? bytes[i % CHECK_WINDOW] : bytes[i];
+	}
+
+	int errors = 0;
+	int pos = 0;
+	for (int c = 0; pos < len && errors == 0; c++) {
+		int push = chunks[c % num_chunks] < len - pos ? chunks[c % num_chunks] : len - pos;
+		histogram_window_push(&w, &stream[pos], push);
+		pos += push;
+
+		unsigned int gold[BIN_SIZE];
+		int first = pos > CHECK_WINDOW ? pos - CHECK_WINDOW : 0;
+		memset(gold, 0, sizeof(gold));
+		for (int i = first; i < pos; i++) {
+			gold[stream[i]]++;
+		}
+		unsigned int count = pos - first;
+		unsigned int cdf = 0;
+		int median = -1;
+		int mode = 0;
+		for (int v = 0; v < BIN_SIZE; v++) {
+			cdf += gold[v];
+			if (median < 0 && 2*cdf >= count) {
+				median = v;
+			}
+			mode = gold[v] > gold[mode] ? v : mode;
+			if (w.counts[v] != gold[v] || histogram_window_cdf(&w, v) != cdf) {
+				printf("Error in window at element %d after %d samples golden= %u, hw=%u\n", v, pos, gold[v], w.counts[v]);
+				errors++;
+			}
+		}
+		int hw_median = histogram_window_quantile(&w, 0.5);
+		int hw_mode = histogram_window_mode(&w);
+		if (hw_median != median || hw_mode != mode) {
+			printf("Error in window after %d samples golden median= %d mode= %d, hw=%d %d\n", pos, median, mode, hw_median, hw_mode);
+			errors++;
+		}
+		int lowest = 0;
+		int highest = BIN_SIZE - 1;
+		while (gold[lowest] == 0) {
+			lowest++;
+		}
+		while (gold[highest] == 0) {
+			highest--;
+		}
+		if (histogram_window_quantile(&w, NAN) != lowest || histogram_window_quantile(&w, -1.0) != lowest ||
+		    histogram_window_quantile(&w, 1e300) != highest) {
+			printf("Error in window after %d samples out of range quantiles do not clamp to %d and %d\n", pos, lowest, highest);
+			errors++;
+		}
+	}
+
+	histogram_window_release(&w);
+	free(stream);
+	return errors;
+}
+
+
+// A pitched image cut into an uneven 7 x 5 tile grid. The clipped
+// histograms keep their totals and stay within one count of
+// min(count, limit) plus the uniform share, and the LUTs end at the top
+// bin; with all LUTs set to the same inversion the remap is exact.
+#define CHECK_TILED_WIDTH  1000
+#define CHECK_TILED_PITCH  1024
+#define CHECK_TILES_X      7
+#define CHECK_TILES_Y      5
+
+static int check_tiled(const unsigned char *bytes, int n) {
+	const int num_tiles = CHECK_TILES_X*CHECK_TILES_Y;
+	int height = n/CHECK_TILED_PITCH;
+	if (height < CHECK_TILES_Y) {
+		return 0;
+	}
+	BIN_DATA_TYPE *gold = (BIN_DATA_TYPE *)calloc((size_t)num_tiles*BIN_SIZE, sizeof(BIN_DATA_TYPE));
+	BIN_DATA_TYPE *hw = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*num_tiles*BIN_SIZE);
+	unsigned char *luts = (unsigned char *)malloc((size_t)num_tiles*BIN_SIZE);
+	unsigned char *out = (unsigned char *)malloc((size_t)height*CHECK_TILED_WIDTH);
+	int errors = 0;
+	if (!gold || !hw || !luts || !out) {
+		errors = check_alloc_failed("tiled");
+		goto release;
+	}
+
+	for (int y = 0; y < height; y++) {
+		int ty = 0;
+		while ((ty + 1)*height/CHECK_TILES_Y <= y) {
+			ty++;
+		}
+		for (int x = 0; x < CHECK_TILED_WIDTH; x++) {
+			int tx = 0;
+			while ((tx + 1)*CHECK_TILED_WIDTH/CHECK_TILES_X <= x) {
+				tx++;
+			}
+			gold[(ty*CHECK_TILES_X + tx)*BIN_SIZE + bytes[y*CHECK_TILED_PITCH + x]]++;
+		}
+	}
+	if (histogram_tiled(bytes, CHECK_TILED_WIDTH, height, CHECK_TILED_PITCH, CHECK_TILES_X, CHECK_TILES_Y, hw) != 0) {
+		errors = check_alloc_failed("tiled");
+		goto release;
+	}
+	errors += check_bins("tiled", gold, hw, num_tiles*BIN_SIZE);
+
+	{
+		int clip_limit = height*CHECK_TILED_WIDTH/num_tiles/BIN_SIZE + 2;
+		histogram_tiled_clip(hw, num_tiles, clip_limit, luts);
+		for (int t = 0; t < num_tiles; t++) {
+			const BIN_DATA_TYPE *g = &gold[t*BIN_SIZE];
+			const BIN_DATA_TYPE *h = &hw[t*BIN_SIZE];
+			BIN_DATA_TYPE total = 0, clipped_total = 0, excess = 0;
+			for (int v = 0; v < BIN_SIZE; v++) {
+				total += g[v];
+				clipped_total += h[v];
+				excess += g[v] > clip_limit ? g[v] - clip_limit : 0;
+			}
+			for (int v = 0; v < BIN_SIZE; v++) {
+				BIN_DATA_TYPE base = (g[v] < clip_limit ? g[v] : clip_limit) + excess/BIN_SIZE;
+				if (h[v] < base || h[v] > base + 1) {
+					printf("Error in tiled clip at tile %d element %d golden= %d, hw=%d\n", t, v, base, h[v]);
+					errors++;
+				}
+			}
+			if (clipped_total != total || luts[t*BIN_SIZE + BIN_SIZE - 1] != BIN_SIZE - 1) {
+				printf("Error in tiled clip at tile %d golden total= %d, hw=%d lut end=%d\n", t, total, clipped_total, luts[t*BIN_SIZE + BIN_SIZE - 1]);
+				errors++;
+			}
+		}
+	}
+
+	for (int i = 0; i < num_tiles*BIN_SIZE; i++) {
+		luts[i] = (unsigned char)(BIN_SIZE - 1 - i % BIN_SIZE);
+	}
+	histogram_tiled_apply(bytes, CHECK_TILED_PITCH, out, CHECK_TILED_WIDTH, CHECK_TILED_WIDTH, height, CHECK_TILES_X, CHECK_TILES_Y, luts);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < CHECK_TILED_WIDTH; x++) {
+			int ref = BIN_SIZE - 1 - bytes[y*CHECK_TILED_PITCH + x];
+			if (out[y*CHECK_TILED_WIDTH + x] != ref) {
+				printf("Error in tiled apply at %d,%d golden= %d, hw=%d\n", x, y, ref, out[y*CHECK_TILED_WIDTH + x]);
+				errors++;
+				goto release;
+			}
+		}
+	}
+
+release:
+	free(gold);
+	free(hw);
+	free(luts);
+	free(out);
+	return errors;
+}
+
+
+// Rectangle queries of both counter widths against a direct count. The
+// image has just over 65536 pixels, so the full-image query has to be
+// refused with 16-bit counters.
+#define CHECK_INTEGRAL_WIDTH  330
+#define CHECK_INTEGRAL_HEIGHT 200
+#define CHECK_INTEGRAL_PITCH  333
+
+static int check_integral(const unsigned char *bytes, int n) {
+	const int rects[][4] = {
+		{0, 0, 1, 1}, {0, 0, 64, 64}, {63, 1, 65, 199}, {5, 7, 329, 190},
+		{100, 100, 330, 200}, {0, 0, 330, 198}, {0, 0, 330, 200}
+	};
+	const int num_rects = sizeof(rects)/sizeof(rects[0]);
+	if (n < CHECK_INTEGRAL_HEIGHT*CHECK_INTEGRAL_PITCH) {
+		return 0;
+	}
+	int errors = 0;
+
+	for (int counter_bits = 16; counter_bits <= 32; counter_bits += 16) {
+		int bins = (counter_bits == 16) ? 128 : 64;
+		int shift = (counter_bits == 16) ? 1 : 2;
+		histogram_integral_t ih;
+		int err = histogram_integral_create(&ih, bytes, CHECK_INTEGRAL_WIDTH, CHECK_INTEGRAL_HEIGHT, CHECK_INTEGRAL_PITCH, bins, counter_bits);
+		if (err != 0) {
+			errors += check_alloc_failed("integral");
+			continue;
+		}
+		for (int r = 0; r < num_rects; r++) {
+			int x0 = rects[r][0], y0 = rects[r][1], x1 = rects[r][2], y1 = rects[r][3];
+			BIN_DATA_TYPE gold[BIN_SIZE];
+			BIN_DATA_TYPE hw[BIN_SIZE];
+			memset(gold, 0, sizeof(gold));
+			for (int y = y0; y < y1; y++) {
+				for (int x = x0; x < x1; x++) {
+					gold[bytes[y*CHECK_INTEGRAL_PITCH + x] >> shift]++;
+				}
+			}
+			int refused = (counter_bits == 16 && (x1 - x0)*(y1 - y0) >= 65536);
+			err = histogram_integral_query(&ih, x0, y0, x1, y1, hw);
+			if ((err != 0) != refused) {
+				printf("Error in integral query %d,%d,%d,%d with %d-bit counters: returned %d\n", x0, y0, x1, y1, counter_bits, err);
+				errors++;
+			} else if (err == 0) {
+				errors += check_bins("integral", gold, hw, bins);
+			}
+		}
+		histogram_integral_release(&ih);
+	}
+	return errors;
+}
+
+
+// Regions of interest at odd offsets inside a frame of the check bytes,
+// read in place, plus descriptors that have to be refused.
+static int check_image(const unsigned char *bytes, int n) {
+	const int rois[][4] = { {0, 0, 1000, 1000}, {3, 5, 997, 17}, {1, 1, 1, 900}, {17, 0, 63, 1000} };
+	const int num_rois = sizeof(rois)/sizeof(rois[0]);
+	const int pitch = 1000;
+	int frame_height = n/pitch;
+	int errors = 0;
+
+	for (int r = 0; r < num_rois; r++) {
+		int x0 = rois[r][0], y0 = rois[r][1];
+		int width = rois[r][2], height = rois[r][3];
+		if (y0 + height > frame_height || x0 + width > pitch) {
+			continue;
+		}
+		histogram_image_t image = { &bytes[y0*pitch + x0], width, height, pitch };
+		BIN_DATA_TYPE gold[BIN_SIZE];
+		BIN_DATA_TYPE hw[BIN_SIZE];
+		memset(gold, 0, sizeof(gold));
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				gold[image.base[y*pitch + x]]++;
+			}
+		}
+		if (histogram_cpu_image(&image, hw) != 0) {
+			printf("Error in image: region %d,%d %dx%d refused\n", x0, y0, width, height);
+			errors++;
+			continue;
+		}
+		errors += check_bins("image", gold, hw, BIN_SIZE);
+	}
+
+	BIN_DATA_TYPE hw[BIN_SIZE];
+	histogram_image_t narrow = { bytes, 10, 2, 9 };
+	histogram_image_t negative = { bytes, 4, -1, 9 };
+	if (histogram_cpu_image(&narrow, hw) != -1 || histogram_cpu_image(&negative, hw) != -1) {
+		printf("Error in image: invalid descriptor accepted\n");
+		errors++;
+	}
+	return errors;
+}
+
+
+// A mask that alternates between rejected, accepted and mixed groups of
+// 64, on an unaligned range whose length is not a multiple of 64; the
+// same selection as a bitmask; and value ranges including an empty one.
+static int check_masked(const unsigned char *bytes, int n) {
+	const int ranges[][2] = { {0, 255}, {10, 10}, {1, 254}, {200, 50} };
+	const int num_ranges = sizeof(ranges)/sizeof(ranges[0]);
+	int len = n > 2 ? n - 2 : 0;
+	const unsigned char *data = bytes + 1;
+	unsigned char *mask = (unsigned char *)malloc(len > 0 ? len : 1);
+	uint64_t *bits = (uint64_t *)calloc(len/64 + 1, sizeof(uint64_t));
+	BIN_DATA_TYPE gold[BIN_SIZE];
+	BIN_DATA_TYPE hw[BIN_SIZE];
+	int errors = 0;
+	if (!mask || !bits) {
+		free(mask);
+		free(bits);
+		return check_alloc_failed("masked");
+	}
+
+	memset(gold, 0, sizeof(gold));
+	for (int i = 0; i < len; i++) {
+		int group = (i/64) % 3;
+		mask[i] = (group == 0) ? 0 : (group == 1 ? 1 : (bytes[i] & 1)*0x80);
+		if (mask[i]) {
+			bits[i/64] |= (uint64_t)1 << (i % 64);
+			gold[data[i]]++;
+		}
+	}
+	histogram_cpu_masked(data, mask, hw, len);
+	errors += check_bins("masked", gold, hw, BIN_SIZE);
+	histogram_cpu_bitmask(data, bits, hw, len);
+	errors += check_bins("bitmask", gold, hw, BIN_SIZE);
+
+	for (int r = 0; r < num_ranges; r++) {
+		memset(gold, 0, sizeof(gold));
+		for (int i = 0; i < len; i++) {
+			if (data[i] >= ranges[r][0] && data[i] <= ranges[r][1]) {
+				gold[data[i]]++;
+			}
+		}
+		histogram_cpu_range(data, (INPUT_DATA_TYPE)ranges[r][0], (INPUT_DATA_TYPE)ranges[r][1], hw, len);
+		errors += check_bins("range", gold, hw, BIN_SIZE);
+	}
+
+	free(mask);
+	free(bits);
+	return errors;
+}
+
+
+// Hash table: keys added from a small table (so it has to grow), some with
+// zero counts that must not create entries, then every third key removed.
+// Grouped: a group count with dense partials and one large enough to spill
+// to hash partials, with group ids past the end that must be ignored.
+#define CHECK_HASH_KEYS 5000
+
+static int check_hash(const unsigned char *bytes, int n) {
+	uint64_t *gold = (uint64_t *)calloc(CHECK_HASH_KEYS, sizeof(uint64_t));
+	histogram_hash_t table;
+	int errors = 0;
+	if (!gold || histogram_hash_create(&table, 16) != 0) {
+		free(gold);
+		return check_alloc_failed("hash");
+	}
+
+	for (int i = 0; i < n; i++) {
+		int k = (int)((bytes[i] << 8 | bytes[(i*31) % n]) % CHECK_HASH_KEYS);
+		uint64_t count = (i % 5 == 0) ? 0 : (uint64_t)(i & 3);
+		gold[k] += count;
+		if (histogram_hash_add(&table, (uint64_t)k*0x9E3779B97F4A7C15ULL, count) != 0) {
+			errors += check_alloc_failed("hash");
+			break;
+		}
+	}
+	for (int pass = 0; pass < 2 && errors == 0; pass++) {
+		size_t size = 0;
+		for (int k = 0; k < CHECK_HASH_KEYS; k++) {
+			uint64_t key = (uint64_t)k*0x9E3779B97F4A7C15ULL;
+			uint64_t hw = histogram_hash_find(&table, key);
+			if (hw != gold[k]) {
+				printf("Error in hash at key %d golden= %llu, hw=%llu\n", k, (unsigned long long)gold[k], (unsigned long long)hw);
+				errors++;
+			}
+			size += (gold[k] != 0);
+		}
+		if (table.size != size) {
+			printf("Error in hash size golden= %zu, hw=%zu\n", size, table.size);
+			errors++;
+		}
+		for (int k = 0; k < CHECK_HASH_KEYS; k += 3) {
+			histogram_hash_remove(&table, (uint64_t)k*0x9E3779B97F4A7C15ULL);
+			gold[k] = 0;
+		}
+	}
+	histogram_hash_release(&table);
+	free(gold);
+
+	const int group_counts[] = {7, 3000};
+	for (int c = 0; c < 2; c++) {
+		int num_groups = group_counts[c];
+		unsigned int *groups = (unsigned int *)malloc(sizeof(unsigned int)*(n > 0 ? n : 1));
+		BIN_DATA_TYPE *matrix_gold = (BIN_DATA_TYPE *)calloc((size_t)num_groups*BIN_SIZE, sizeof(BIN_DATA_TYPE));
+		BIN_DATA_TYPE *matrix = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*num_groups*BIN_SIZE);
+		if (groups && matrix_gold && matrix) {
+			for (int i = 0; i < n; i++) {
+				groups[i] = (unsigned int)((i*2654435761u) >> 8) % (num_groups + num_groups/4 + 1);
+				if (groups[i] < (unsigned int)num_groups) {
+					matrix_gold[groups[i]*BIN_SIZE + bytes[i]]++;
+				}
+			}
+		}
+		if (!groups || !matrix_gold || !matrix || histogram_grouped(bytes, groups, n, num_groups, matrix) != 0) {
+			errors += check_alloc_failed("grouped");
+		} else {
+			errors += check_bins("grouped", matrix_gold, matrix, num_groups*BIN_SIZE);
+		}
+		free(groups);
+		free(matrix_gold);
+		free(matrix);
+	}
+	return errors;
+}
+
+
+// 32-bit keys near the top of the range (dense path, sorted result) and
+// 64-bit keys spread over the whole range (partitioned hash path), both
+// against a sorted copy of the keys.
+static int check_sparse(const unsigned char *bytes, int n) {
+	uint32_t *keys32 = (uint32_t *)malloc(sizeof(uint32_t)*(n > 0 ? n : 1));
+	uint64_t *keys64 = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t *sorted = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	int errors = 0;
+	if (!keys32 || !keys64 || !sorted) {
+		errors = check_alloc_failed("sparse");
+		goto release;
+	}
+	for (int i = 0; i < n; i++) {
+		keys32[i] = 4294900000u + (uint32_t)bytes[i]*100u + (uint32_t)(i % 3);
+		keys64[i] = ((uint64_t)bytes[i] << 8 | bytes[(i*7) % n])*0x9E3779B97F4A7C15ULL;
+	}
+
+	for (int wide = 0; wide < 2; wide++) {
+		histogram_sparse_t result;
+		int err = wide ? histogram_sparse_u64(keys64, n, &result) : histogram_sparse_u32(keys32, n, &result);
+		if (err != 0) {
+			errors += check_alloc_failed("sparse");
+			continue;
+		}
+		for (int i = 0; i < n; i++) {
+			sorted[i] = wide ? keys64[i] : keys32[i];
+		}
+		qsort(sorted, n, sizeof(uint64_t), check_compare_u64);
+
+		// the result, as (key, count) pairs sorted by key
+		uint64_t *pairs = (uint64_t *)malloc(sizeof(uint64_t)*2*(result.size + 1));
+		if (!pairs) {
+			histogram_sparse_release(&result);
+			errors += check_alloc_failed("sparse");
+			continue;
+		}
+		for (size_t j = 0; j < result.size; j++) {
+			pairs[2*j]     = result.keys[j];
+			pairs[2*j + 1] = result.counts[j];
+		}
+		qsort(pairs, result.size, 2*sizeof(uint64_t), check_compare_u64);
+		if (!wide) {
+			for (size_t j = 0; j < result.size; j++) {
+				if (result.keys[j] != pairs[2*j]) {
+					printf("Error in sparse: dense result not sorted at %zu\n", j);
+					errors++;
+					break;
+				}
+			}
+		}
+
+		size_t j = 0;
+		for (int i = 0; i < n; ) {
+			int run = 1;
+			while (i + run < n && sorted[i + run] == sorted[i]) {
+				run++;
+			}
+			if (j >= result.size || pairs[2*j] != sorted[i] || pairs[2*j + 1] != (uint64_t)run) {
+				printf("Error in sparse at key %llu golden= %d, hw=%llu\n", (unsigned long long)sorted[i], run,
+				       j < result.size ? (unsigned long long)pairs[2*j + 1] : 0ULL);
+				errors++;
+				break;
+			}
+			i += run;
+			j++;
+		}
+		if (errors == 0 && j != result.size) {
+			printf("Error in sparse: golden %zu keys, hw=%zu\n", j, result.size);
+			errors++;
+		}
+		free(pairs);
+		histogram_sparse_release(&result);
+	}
+
+release:
+	free(keys32);
+	free(keys64);
+	free(sorted);
+	return errors;
+}
+
+
+// Eight heavy keys taking half of the stream, the rest unique keys. The
+// answer has to be exactly the heavy keys, every reported count has to
+// bracket the true frequency, and the sketch may only overestimate.
+#define CHECK_TOPK_HEAVY 8
+
+static int check_topk(const unsigned char *bytes, int n) {
+	uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t gold[CHECK_TOPK_HEAVY];
+	histogram_topk_item_t items[CHECK_TOPK_HEAVY];
+	histogram_topk_t summary;
+	int errors = 0;
+	if (!keys) {
+		return check_alloc_failed("topk");
+	}
+	memset(gold, 0, sizeof(gold));
+	for (int i = 0; i < n; i++) {
+		if (bytes[i] < 128) {
+			keys[i] = 0xABCD0000ULL + bytes[i] % CHECK_TOPK_HEAVY;
+			gold[bytes[i] % CHECK_TOPK_HEAVY]++;
+		} else {
+			keys[i] = (uint64_t)i << 20;
+		}
+	}
+	if (histogram_topk(keys, n, 64, 1024, &summary) != 0) {
+		free(keys);
+		return check_alloc_failed("topk");
+	}
+
+	int num_items = histogram_topk_query(&summary, CHECK_TOPK_HEAVY, items);
+	if (num_items < 0) {
+		histogram_topk_release(&summary);
+		free(keys);
+		return check_alloc_failed("topk");
+	}
+	int expected = 0;
+	for (int h = 0; h < CHECK_TOPK_HEAVY; h++) {
+		expected += (gold[h] > 0);
+	}
+	int num_expected = summary.size < CHECK_TOPK_HEAVY ? summary.size : CHECK_TOPK_HEAVY;
+	if (num_items != num_expected || summary.total != (uint64_t)n) {
+		printf("Error in topk: golden %d items total=%d, hw=%d total=%llu\n", num_expected, n, num_items, (unsigned long long)summary.total);
+		errors++;
+	}
+	int found = 0;
+	for (int j = 0; j < num_items; j++) {
+		uint64_t h = items[j].key - 0xABCD0000ULL;
+		uint64_t f = (h < CHECK_TOPK_HEAVY) ? gold[h] : 0;
+		found += (h < CHECK_TOPK_HEAVY && f > 0);
+		if (items[j].count < f || items[j].count - items[j].error > f || (j > 0 && items[j].count > items[j - 1].count)) {
+			printf("Error in topk at item %d key %llu golden= %llu, hw=%llu-%llu\n", j, (unsigned long long)items[j].key,
+			       (unsigned long long)f, (unsigned long long)(items[j].count - items[j].error), (unsigned long long)items[j].count);
+			errors++;
+		}
+	}
+	if (found != expected) {
+		printf("Error in topk: golden %d heavy keys, hw=%d\n", expected, found);
+		errors++;
+	}
+	for (int h = 0; h < CHECK_TOPK_HEAVY; h++) {
+		if (histogram_topk_estimate(&summary, 0xABCD0000ULL + h) < gold[h]) {
+			printf("Error in topk estimate at key %d golden= %llu\n", h, (unsigned long long)gold[h]);
+			errors++;
+		}
+	}
+	if (n > 0 && bytes[n - 1] >= 128 && histogram_topk_estimate(&summary, (uint64_t)(n - 1) << 20) < 1) {
+		printf("Error in topk estimate of a unique key\n");
+		errors++;
+	}
+
+	histogram_topk_release(&summary);
+	free(keys);
+	return errors;
+}
+
+
+// Values from 1 to 2^36 (highest), a few negative or above it, recorded
+// through the per-thread shards. Percentiles (also out of [0, 100]), the
+// extremes and the mean are compared with the sorted values, to within
+// the bucket width of 3 significant digits.
+#define CHECK_HDR_HIGHEST ((int64_t)1 << 36)
+
+static int check_hdr(const unsigned char *bytes, int n) {
+	const double percentiles[] = {-5.0, 0.0, 1.0, 50.0, 90.0, 99.0, 99.9, 100.0, 150.0};
+	const int num_percentiles = sizeof(percentiles)/sizeof(percentiles[0]);
+	int64_t *values = (int64_t *)malloc(sizeof(int64_t)*(n > 0 ? n : 1));
+	int64_t *sorted = (int64_t *)malloc(sizeof(int64_t)*(n > 0 ? n : 1));
+	histogram_hdr_recorder_t recorder;
+	histogram_hdr_t snapshot;
+	int errors = 0;
+	if (!values || !sorted ||
+	    histogram_hdr_recorder_create(&recorder, histogram_cpu_threads(), 1, CHECK_HDR_HIGHEST, 3) != 0) {
+		free(values);
+		free(sorted);
+		return check_alloc_failed("hdr");
+	}
+	if (histogram_hdr_create(&snapshot, 1, CHECK_HDR_HIGHEST, 3) != 0) {
+		histogram_hdr_recorder_release(&recorder);
+		free(values);
+		free(sorted);
+		return check_alloc_failed("hdr");
+	}
+
+	int m = 0;
+	size_t out_of_range = 0;
+	for (int i = 0; i < n; i++) {
+		values[i] = ((int64_t)bytes[i] + 1) << (bytes[(i*13) % n] % 29);
+		if (i % 1000 == 7) {
+			values[i] = (i % 2000 == 7) ? -values[i] : CHECK_HDR_HIGHEST + values[i];
+			out_of_range++;
+		} else {
+			sorted[m++] = values[i];
+		}
+	}
+	qsort(sorted, m, sizeof(int64_t), check_compare_i64);
+
+	size_t hw_out = histogram_hdr_recorder_record(&recorder, values, n);
+	histogram_hdr_recorder_snapshot(&recorder, &snapshot);
+	if (hw_out != out_of_range || snapshot.total != (uint64_t)m) {
+		printf("Error in hdr: golden %d recorded %zu out of range, hw=%llu %zu\n", m, out_of_range, (unsigned long long)snapshot.total, hw_out);
+		errors++;
+	}
+	if (m > 0) {
+		for (int p = 0; p < num_percentiles; p++) {
+			double q = percentiles[p] < 0 ? 0 : (percentiles[p] > 100 ? 100 : percentiles[p]);
+			int64_t rank = (int64_t)ceil(q/100.0*m);
+			int64_t gold = sorted[(rank < 1 ? 1 : rank) - 1];
+			int64_t hw = histogram_hdr_percentile(&snapshot, percentiles[p]);
+			if (hw < gold || hw > gold + gold/500 + 1) {
+				printf("Error in hdr at percentile %g golden= %lld, hw=%lld\n", percentiles[p], (long long)gold, (long long)hw);
+				errors++;
+			}
+		}
+		int64_t hw_min = histogram_hdr_min(&snapshot);
+		int64_t hw_max = histogram_hdr_max(&snapshot);
+		if (hw_min > sorted[0] || hw_min < sorted[0] - sorted[0]/500 ||
+		    hw_max < sorted[m - 1] || hw_max > sorted[m - 1] + sorted[m - 1]/500 + 1) {
+			printf("Error in hdr extremes golden= %lld %lld, hw=%lld %lld\n", (long long)sorted[0], (long long)sorted[m - 1], (long long)hw_min, (long long)hw_max);
+			errors++;
+		}
+		double mean = 0;
+		for (int i = 0; i < m; i++) {
+			mean += (double)sorted[i];
+		}
+		mean /= m;
+		if (fabs(histogram_hdr_mean(&snapshot) - mean) > mean/500) {
+			printf("Error in hdr mean golden= %f, hw=%f\n", mean, histogram_hdr_mean(&snapshot));
+			errors++;
+		}
+	}
+
+	histogram_hdr_release(&snapshot);
+	histogram_hdr_recorder_release(&recorder);
+	free(values);
+	free(sorted);
+	return errors;
+}
+
+
+// An index over more than QUERY_PARALLEL_BINS bins, built from one half of
+// the pairs and accumulated with the other. Counts, ranks, ranges, the
+// mode and quantiles (also for p outside [0, 1] and NaN) are compared with
+// a naive prefix sum.
+#define CHECK_QUERY_BINS 100000
+
+static int check_query(const unsigned char *bytes, int n) {
+	const double ps[] = {-0.5, 0.0, 1e-7, 0.25, 0.5, 0.999, 1.0, 2.0, NAN};
+	const int num_ps = sizeof(ps)/sizeof(ps[0]);
+	BIN_DATA_TYPE *first = (BIN_DATA_TYPE *)calloc(CHECK_QUERY_BINS, sizeof(BIN_DATA_TYPE));
+	BIN_DATA_TYPE *second = (BIN_DATA_TYPE *)calloc(CHECK_QUERY_BINS, sizeof(BIN_DATA_TYPE));
+	uint64_t *prefix = (uint64_t *)malloc(sizeof(uint64_t)*CHECK_QUERY_BINS);
+	histogram_query_t q;
+	int errors = 0;
+	if (!first || !second || !prefix || histogram_query_create(&q, CHECK_QUERY_BINS) != 0) {
+		free(first);
+		free(second);
+		free(prefix);
+		return check_alloc_failed("query");
+	}
+
+	for (int i = 0; i + 1 < n; i++) {
+		int b = (bytes[i]*391 + bytes[i + 1]*7 + i % 5) % CHECK_QUERY_BINS;
+		(i < n/2 ? first : second)[b]++;
+	}
+	histogram_query_build(&q, first);
+	histogram_query_accumulate(&q, second);
+
+	uint64_t running = 0;
+	int mode = 0;
+	for (int b = 0; b < CHECK_QUERY_BINS; b++) {
+		uint64_t count = (uint64_t)first[b] + (uint64_t)second[b];
+		running += count;
+		prefix[b] = running;
+		mode = count > (uint64_t)first[mode] + (uint64_t)second[mode] ? b : mode;
+		if (histogram_query_count(&q, b) != count || histogram_query_rank(&q, b) != running) {
+			printf("Error in query at element %d golden= %llu, hw=%llu\n", b, (unsigned long long)count, (unsigned long long)histogram_query_count(&q, b));
+			errors++;
+			break;
+		}
+	}
+	if (q.total != running || (running && q.mode != mode) ||
+	    histogram_query_range(&q, 100, 49999) != prefix[49999] - prefix[99] ||
+	    histogram_query_range(&q, -10, CHECK_QUERY_BINS + 10) != running || histogram_query_range(&q, 7, 6) != 0) {
+		printf("Error in query: golden total= %llu mode= %d, hw=%llu %d\n", (unsigned long long)running, mode, (unsigned long long)q.total, q.mode);
+		errors++;
+	}
+	for (int k = 0; k < num_ps && running; k++) {
+		double p = (ps[k] >= 0.0) ? (ps[k] > 1.0 ? 1.0 : ps[k]) : 0.0;
+		uint64_t target = (uint64_t)ceil(p*(double)running);
+		target = target < 1 ? 1 : target;
+		int gold = 0;
+		while (prefix[gold] < target) {
+			gold++;
+		}
+		int hw = histogram_query_quantile(&q, ps[k]);
+		double hw_interp = histogram_query_quantile_interp(&q, ps[k]);
+		if (hw != gold || !(hw_interp >= gold && hw_interp <= gold + 1)) {
+			printf("Error in query quantile %g golden= %d, hw=%d (%f)\n", ps[k], gold, hw, hw_interp);
+			errors++;
+		}
+	}
+
+	histogram_query_release(&q);
+	free(first);
+	free(second);
+	free(prefix);
+	return errors;
+}
+
+
+// Every metric over a float and a quantised set of 37-bin rows (not a
+// multiple of DISTANCE_ROW_ALIGN), against double references on the stored
+// probabilities; top-k must return the smallest batch distances in order.
+#define CHECK_DISTANCE_BINS 37
+#define CHECK_DISTANCE_ROWS 200
+#define CHECK_DISTANCE_K    10
+
+static double check_distance_gold(const double *p, const double *q, int metric) {
+	double d = 0, cp = 0, cq = 0;
+	for (int b = 0; b < CHECK_DISTANCE_BINS; b++) {
+		if (metric == DISTANCE_CHI_SQUARE) {
+			d += (p[b] + q[b] > 0) ? (p[b] - q[b])*(p[b] - q[b])/(p[b] + q[b]) : 0;
+		} else if (metric == DISTANCE_INTERSECTION) {
+			d += p[b] < q[b] ? p[b] : q[b];
+		} else if (metric == DISTANCE_BHATTACHARYYA) {
+			d += sqrt(p[b]*q[b]);
+		} else if (metric == DISTANCE_KL) {
+			d += (q[b] > 0) ? q[b]*(log2(q[b]) - log2(p[b] + DISTANCE_KL_EPSILON)) : 0;
+		} else {
+			cp += p[b];
+			cq += q[b];
+			d += fabs(cp - cq);
+		}
+	}
+	if (metric == DISTANCE_INTERSECTION) {
+		return 1 - d;
+	}
+	if (metric == DISTANCE_BHATTACHARYYA) {
+		return d < 1 ? sqrt(1 - d) : 0;
+	}
+	return d;
+}
+
+static int check_distance(const unsigned char *bytes, int n) {
+	const int needed = (CHECK_DISTANCE_ROWS + 1)*CHECK_DISTANCE_BINS*4;
+	BIN_DATA_TYPE *matrix = (BIN_DATA_TYPE *)calloc((size_t)(CHECK_DISTANCE_ROWS + 1)*CHECK_DISTANCE_BINS, sizeof(BIN_DATA_TYPE));
+	float *distances = (float *)malloc(sizeof(float)*CHECK_DISTANCE_ROWS);
+	histogram_distance_match_t matches[CHECK_DISTANCE_K];
+	int errors = 0;
+	if (n < needed) {
+		free(matrix);
+		free(distances);
+		return 0;
+	}
+	if (!matrix || !distances) {
+		free(matrix);
+		free(distances);
+		return check_alloc_failed("distance");
+	}
+	// row r counts 4*bins bytes; every row leaves some bins empty
+	for (int r = 0; r <= CHECK_DISTANCE_ROWS; r++) {
+		for (int i = 0; i < 4*CHECK_DISTANCE_BINS; i++) {
+			int v = bytes[r*4*CHECK_DISTANCE_BINS + i];
+			matrix[r*CHECK_DISTANCE_BINS + (v*v % 251) % CHECK_DISTANCE_BINS]++;
+		}
+	}
+	const BIN_DATA_TYPE *query = &matrix[CHECK_DISTANCE_ROWS*CHECK_DISTANCE_BINS];
+
+	for (int quantized = 0; quantized < 2; quantized++) {
+		histogram_distance_set_t set;
+		if (histogram_distance_set_create(&set, CHECK_DISTANCE_BINS, CHECK_DISTANCE_ROWS, quantized) != 0) {
+			errors += check_alloc_failed("distance");
+			continue;
+		}
+		if (histogram_distance_set_load(&set, matrix, CHECK_DISTANCE_ROWS) != 0) {
+			printf("Error in distance: %d rows refused\n", CHECK_DISTANCE_ROWS);
+			errors++;
+			histogram_distance_set_release(&set);
+			continue;
+		}
+		for (int metric = 0; metric < DISTANCE_METRICS; metric++) {
+			if (histogram_distance_batch(&set, query, metric, distances) != 0) {
+				errors += check_alloc_failed("distance");
+				continue;
+			}
+			for (int r = 0; r < CHECK_DISTANCE_ROWS; r++) {
+				double p[CHECK_DISTANCE_BINS], q[CHECK_DISTANCE_BINS];
+				double row_total = 0, query_total = 0;
+				for (int b = 0; b < CHECK_DISTANCE_BINS; b++) {
+					row_total += matrix[r*CHECK_DISTANCE_BINS + b];
+					query_total += query[b];
+				}
+				for (int b = 0; b < CHECK_DISTANCE_BINS; b++) {
+					p[b] = matrix[r*CHECK_DISTANCE_BINS + b]/row_total;
+					if (quantized) {
+						p[b] = floor(p[b]*DISTANCE_QUANT_SCALE + 0.5)/DISTANCE_QUANT_SCALE;
+					}
+					q[b] = query[b]/query_total;
+				}
+				double gold = check_distance_gold(p, q, metric);
+				if (fabs(gold - distances[r]) > 1e-3) {
+					printf("Error in distance metric %d%s at row %d golden= %f, hw=%f\n", metric, quantized ? " (quantized)" : "", r, gold, distances[r]);
+					errors++;
+				}
+			}
+
+			int num_matches = histogram_distance_topk(&set, query, metric, CHECK_DISTANCE_K, matches);
+			for (int j = 0; j < num_matches; j++) {
+				size_t rank = 0;
+				for (int r = 0; r < CHECK_DISTANCE_ROWS; r++) {
+					float d = distances[r];
+					float m = distances[matches[j].index];
+					rank += (d < m || (d == m && (size_t)r < matches[j].index));
+				}
+				if (rank != (size_t)j || matches[j].distance != distances[matches[j].index]) {
+					printf("Error in distance topk metric %d at match %d: row %zu has rank %zu\n", metric, j, matches[j].index, rank);
+					errors++;
+				}
+			}
+			if (num_matches != CHECK_DISTANCE_K) {
+				printf("Error in distance topk metric %d: golden %d matches, hw=%d\n", metric, CHECK_DISTANCE_K, num_matches);
+				errors++;
+			}
+		}
+		histogram_distance_set_release(&set);
+	}
+
+	free(matrix);
+	free(distances);
+	return errors;
+}
+
+
+typedef struct {
+	const unsigned char *file;
+	uint64_t             next;       // file position of the first new byte
+	int                  errors;
+} check_stream_t;
+
+// Every chunk has to start with the overlap and continue where the last
+// one stopped.
+static int check_stream_chunk(const unsigned char *data, size_t size, uint64_t offset, void *ctx) {
+	check_stream_t *c = (check_stream_t *)ctx;
+	if (offset > c->next || offset + size <= c->next || memcmp(data, &c->file[offset], size) != 0) {
+		printf("Error in stream at offset %llu, expected new bytes from %llu\n", (unsigned long long)offset, (unsigned long long)c->next);
+		c->errors++;
+		return 1;
+	}
+	c->next = offset + size;
+	return 0;
+}
+
+
+// Entropy maps of the check bytes with a low-entropy stretch in the middle,
+// for disjoint and overlapping blocks, against a per-block recount; the
+// same bytes written to a temporary file must give the same map, and
+// streaming the file in small chunks must reproduce it byte for byte.
+static int check_entropy(const unsigned char *bytes, int n) {
+	const size_t layouts[][2] = { {4096, 4096}, {1000, 300} };
+	unsigned char *data = (unsigned char *)malloc(n > 0 ? n : 1);
+	float *entropy = (float *)malloc(sizeof(float)*(n/300 + 1));
+	char filename[] = "/tmp/histogram_checkXXXXXX";
+	int errors = 0;
+	if (!data || !entropy) {
+		free(data);
+		free(entropy);
+		return check_alloc_failed("entropy");
+	}
+	for (int i = 0; i < n; i++) {
+		data[i] = (i > n/3 && i < n/2) ? (unsigned char)(i % 4) : bytes[i];
+	}
+	int fd = mkstemp(filename);
+	if (fd < 0 || write(fd, data, n) != (ssize_t)n) {
+		printf("Error in entropy: cannot write %s\n", filename);
+		errors++;
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+
+	for (int l = 0; l < 2; l++) {
+		size_t block_size = layouts[l][0];
+		size_t stride = layouts[l][1];
+		size_t num_blocks = histogram_block_entropy_count(n, block_size, stride);
+		if (histogram_block_entropy(data, n, block_size, stride, entropy) != 0) {
+			errors += check_alloc_failed("entropy");
+			continue;
+		}
+		for (size_t k = 0; k < num_blocks; k++) {
+			unsigned int counts[BIN_SIZE];
+			memset(counts, 0, sizeof(counts));
+			for (size_t i = k*stride; i < k*stride + block_size; i++) {
+				counts[data[i]]++;
+			}
+			double gold = 0;
+			for (int v = 0; v < BIN_SIZE; v++) {
+				double p = (double)counts[v]/(double)block_size;
+				gold -= (p > 0) ? p*log2(p) : 0;
+			}
+			if (fabs(gold - entropy[k]) > 1e-4) {
+				printf("Error in entropy at block %zu golden= %f, hw=%f\n", k, gold, entropy[k]);
+				errors++;
+				break;
+			}
+		}
+
+		histogram_entropy_map_t map;
+		if (fd >= 0 && errors == 0) {
+			if (histogram_block_entropy_file(filename, block_size, stride, &map) != 0) {
+				printf("Error in entropy: cannot map %s\n", filename);
+				errors++;
+				continue;
+			}
+			if (map.num_blocks != num_blocks || (num_blocks && memcmp(map.entropy, entropy, sizeof(float)*num_blocks) != 0)) {
+				printf("Error in entropy: file map differs, golden %zu blocks, hw=%zu\n", num_blocks, map.num_blocks);
+				errors++;
+			}
+			histogram_entropy_map_release(&map);
+		}
+	}
+
+	if (fd >= 0 && errors == 0) {
+		check_stream_t stream = { data, 0, 0 };
+		int err = histogram_stream_file(filename, 4093, 17, check_stream_chunk, &stream);
+		if (err != 0 || stream.next != (uint64_t)n || histogram_stream_file_size(filename) != n) {
+			printf("Error in stream: returned %d after %llu of %d bytes\n", err, (unsigned long long)stream.next, n);
+			errors++;
+		}
+		errors += stream.errors;
+	}
+
+	if (fd >= 0) {
+		unlink(filename);
+	}
+	free(data);
+	free(entropy);
+	return errors;
+}
+
+
+// Bigrams against a naive count, through histogram_bigram and through two
+// accumulations. Hashed trigrams of a period-3 pattern fall into at most
+// three bins with the exact trigram counts, and the trigrams of the check
+// bytes keep their total. The file versions must match the buffer ones.
+#define CHECK_NGRAM_BITS 12
+
+static int check_ngram(const unsigned char *bytes, int n) {
+	BIN_DATA_TYPE *gold = (BIN_DATA_TYPE *)calloc(NGRAM_BIGRAM_BINS, sizeof(BIN_DATA_TYPE));
+	BIN_DATA_TYPE *bigram = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*NGRAM_BIGRAM_BINS);
+	uint64_t *hist = (uint64_t *)calloc(NGRAM_BIGRAM_BINS, sizeof(uint64_t));
+	uint64_t *file_hist = (uint64_t *)malloc(sizeof(uint64_t)*NGRAM_BIGRAM_BINS);
+	unsigned char *pattern = (unsigned char *)malloc(n > 0 ? n : 1);
+	char filename[] = "/tmp/histogram_checkXXXXXX";
+	int errors = 0;
+	if (!gold || !bigram || !hist || !file_hist || !pattern || n < 3) {
+		errors = (n < 3) ? 0 : check_alloc_failed("ngram");
+		goto release;
+	}
+
+	for (int i = 0; i + 1 < n; i++) {
+		gold[bytes[i] << 8 | bytes[i + 1]]++;
+	}
+	if (histogram_bigram(bytes, n, bigram) != 0 ||
+	    histogram_ngram_accumulate(bytes, n, 2, 0, hist) != 0 || histogram_ngram_accumulate(bytes, n, 2, 0, hist) != 0) {
+		errors = check_alloc_failed("ngram");
+		goto release;
+	}
+	errors += check_bins("bigram", gold, bigram, NGRAM_BIGRAM_BINS);
+	for (int b = 0; b < NGRAM_BIGRAM_BINS; b++) {
+		if (hist[b] != 2*(uint64_t)gold[b]) {
+			printf("Error in ngram accumulate at element %d golden= %d, hw=%llu\n", b, 2*gold[b], (unsigned long long)hist[b]);
+			errors++;
+			break;
+		}
+	}
+
+	{
+		size_t bins = histogram_ngram_bins(3, CHECK_NGRAM_BITS);
+		uint64_t gold_counts[3] = { 0, 0, 0 };
+		uint64_t total = 0;
+		int used = 0;
+		int unmatched = 0;
+		for (int i = 0; i < n; i++) {
+			pattern[i] = (unsigned char)("\x10\x80\xfe"[i % 3]);
+		}
+		for (int i = 0; i + 2 < n; i++) {
+			gold_counts[i % 3]++;
+		}
+		memset(hist, 0, sizeof(uint64_t)*bins);
+		histogram_ngram_accumulate(pattern, n, 3, CHECK_NGRAM_BITS, hist);
+		for (size_t b = 0; b < bins; b++) {
+			if (hist[b]) {
+				used++;
+				int match = 0;
+				for (int k = 0; k < 3; k++) {
+					match |= (hist[b] == gold_counts[k] || hist[b] == gold_counts[k] + gold_counts[(k + 1) % 3] ||
+					          hist[b] == (uint64_t)n - 2);
+				}
+				unmatched += !match;
+			}
+		}
+		// each used bin holds one trigram, or the sum of colliding ones
+		if (used < 1 || used > 3 || unmatched) {
+			printf("Error in ngram: period-3 trigrams in %d bins, %d with unexpected counts\n", used, unmatched);
+			errors++;
+		}
+
+		memset(hist, 0, sizeof(uint64_t)*bins);
+		histogram_ngram_accumulate(bytes, n, 3, CHECK_NGRAM_BITS, hist);
+		for (size_t b = 0; b < bins; b++) {
+			total += hist[b];
+		}
+		if (total != (uint64_t)n - 2) {
+			printf("Error in ngram: golden %d trigrams, hw=%llu\n", n - 2, (unsigned long long)total);
+			errors++;
+		}
+	}
+
+	{
+		int fd = mkstemp(filename);
+		if (fd < 0 || write(fd, bytes, n) != (ssize_t)n) {
+			printf("Error in ngram: cannot write %s\n", filename);
+			errors++;
+		} else {
+			for (int gram = 2; gram <= 3; gram++) {
+				size_t bins = histogram_ngram_bins(gram, CHECK_NGRAM_BITS);
+				memset(hist, 0, sizeof(uint64_t)*bins);
+				histogram_ngram_accumulate(bytes, n, gram, CHECK_NGRAM_BITS, hist);
+				if (histogram_ngram_file(filename, gram, CHECK_NGRAM_BITS, file_hist) != 0 ||
+				    memcmp(hist, file_hist, sizeof(uint64_t)*bins) != 0) {
+					printf("Error in ngram: %d-gram histogram of the file differs\n", gram);
+					errors++;
+				}
+			}
+		}
+		if (fd >= 0) {
+			close(fd);
+			unlink(filename);
+		}
+	}
+
+release:
+	free(gold);
+	free(bigram);
+	free(hist);
+	free(file_hist);
+	free(pattern);
+	return errors;
+}
+
+
+// Digit histograms against a naive count, and sorts against qsort: u32
+// keys over the whole range with digits computed by the sort, u64 keys
+// whose upper digits are constant (skipped passes) with the precomputed
+// digits passed in.
+static int check_radix(const unsigned char *bytes, int n) {
+	uint32_t *keys32 = (uint32_t *)malloc(sizeof(uint32_t)*(n > 0 ? n : 1));
+	uint64_t *keys64 = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t *gold = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t *scratch = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t digits[8*RADIX_BINS];
+	uint64_t gold_digits[8*RADIX_BINS];
+	int errors = 0;
+	if (!keys32 || !keys64 || !gold || !scratch || n < 4) {
+		errors = (n < 4) ? 0 : check_alloc_failed("radix");
+		goto release;
+	}
+
+	for (int i = 0; i < n; i++) {
+		keys32[i] = (uint32_t)bytes[i] << 24 | (uint32_t)bytes[(i*3) % n] << 16 | (uint32_t)bytes[(i*5) % n] << 8 | (uint32_t)(i & 255);
+		keys64[i] = 0x5A5A000000000000ULL | (uint64_t)keys32[(i*7) % n] << 8 | bytes[(i*11) % n];
+	}
+
+	for (int wide = 0; wide < 2; wide++) {
+		int num_digits = wide ? 8 : 4;
+		memset(gold_digits, 0, sizeof(gold_digits));
+		for (int i = 0; i < n; i++) {
+			uint64_t key = wide ? keys64[i] : keys32[i];
+			gold[i] = key;
+			for (int d = 0; d < num_digits; d++) {
+				gold_digits[d*RADIX_BINS + ((key >> (8*d)) & 255)]++;
+			}
+		}
+		int err = wide ? histogram_radix_digits_u64(keys64, n, digits) : histogram_radix_digits_u32(keys32, n, digits);
+		if (err == 0) {
+			err = wide ? histogram_radix_sort_u64(keys64, scratch, n, digits)
+			           : histogram_radix_sort_u32(keys32, (uint32_t *)scratch, n, (const uint64_t *)NULL);
+		}
+		if (err != 0) {
+			errors += check_alloc_failed("radix");
+			continue;
+		}
+		if (memcmp(digits, gold_digits, sizeof(uint64_t)*num_digits*RADIX_BINS) != 0) {
+			printf("Error in radix: %d-bit digit histograms differ\n", 32*(wide + 1));
+			errors++;
+		}
+		qsort(gold, n, sizeof(uint64_t), check_compare_u64);
+		for (int i = 0; i < n; i++) {
+			uint64_t hw = wide ? keys64[i] : keys32[i];
+			if (hw != gold[i]) {
+				printf("Error in radix sort at element %d golden= %llu, hw=%llu\n", i, (unsigned long long)gold[i], (unsigned long long)hw);
+				errors++;
+				break;
+			}
+		}
+	}
+
+release:
+	free(keys32);
+	free(keys64);
+	free(gold);
+	free(scratch);
+	return errors;
+}
+
+
+// Order-preserving key of a float's bits, the order histogram_select uses.
+static uint64_t check_float_key(float x) {
+	uint32_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+
+// Ranks at both ends and in between, for u32 keys with many duplicates,
+// u64 keys and floats with signed zeros and NaNs; top-k for k = 0, 1,
+// a few hundred and n must hold the largest k values. All against a
+// sorted copy.
+static int check_select(const unsigned char *bytes, int n) {
+	uint32_t *keys32 = (uint32_t *)malloc(sizeof(uint32_t)*(n > 0 ? n : 1));
+	uint64_t *keys64 = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	float *floats = (float *)malloc(sizeof(float)*(n > 0 ? n : 1));
+	uint64_t *gold = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t *out = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	int errors = 0;
+	if (!keys32 || !keys64 || !floats || !gold || !out || n < 2) {
+		errors = (n < 2) ? 0 : check_alloc_failed("select");
+		goto release;
+	}
+
+	for (int i = 0; i < n; i++) {
+		keys32[i] = (uint32_t)bytes[i] << 16 | bytes[(i*3) % n];
+		keys64[i] = ((uint64_t)bytes[i] << 56) | ((uint64_t)i*0x9E3779B97F4A7C15ULL >> 8);
+		int v = bytes[(i*7) % n];
+		floats[i] = (v == 0) ? -0.0f : (v == 1 ? 0.0f : (v == 2 ? NAN : (v == 3 ? -NAN : ((float)v - 128.0f)*1e-3f*(float)(i % 97))));
+	}
+
+	for (int type = 0; type < 3; type++) {
+		for (int i = 0; i < n; i++) {
+			gold[i] = (type == 0) ? keys32[i] : (type == 1 ? keys64[i] : check_float_key(floats[i]));
+		}
+		qsort(gold, n, sizeof(uint64_t), check_compare_u64);
+
+		const size_t ranks[] = { 0, 1, (size_t)n/3, (size_t)n/2, (size_t)n - 2, (size_t)n - 1 };
+		for (int r = 0; r < 6; r++) {
+			size_t k = ranks[r];
+			uint32_t v32 = 0;
+			uint64_t v64 = 0;
+			float vf = 0;
+			int err = (type == 0) ? histogram_select_u32(keys32, n, k, &v32)
+			        : (type == 1 ? histogram_select_u64(keys64, n, k, &v64) : histogram_select_float(floats, n, k, &vf));
+			uint64_t hw = (type == 0) ? v32 : (type == 1 ? v64 : check_float_key(vf));
+			if (err != 0 || hw != gold[k]) {
+				printf("Error in select type %d at rank %zu golden= %llx, hw=%llx (returned %d)\n", type, k, (unsigned long long)gold[k], (unsigned long long)hw, err);
+				errors++;
+			}
+		}
+		uint64_t unused;
+		if (histogram_select_u64(keys64, n, n, &unused) != -1) {
+			printf("Error in select: rank n accepted\n");
+			errors++;
+		}
+
+		const size_t counts[] = { 0, 1, 300, (size_t)n };
+		for (int c = 0; c < 4; c++) {
+			size_t k = counts[c];
+			int err = (type == 0) ? histogram_select_topk_u32(keys32, n, k, (uint32_t *)out)
+			        : (type == 1 ? histogram_select_topk_u64(keys64, n, k, out) : histogram_select_topk_float(floats, n, k, (float *)out));
+			if (err != 0) {
+				errors += check_alloc_failed("select");
+				continue;
+			}
+			// widen in place from the back, the outputs are narrower for u32 and float
+			for (size_t j = k; j-- > 0; ) {
+				out[j] = (type == 0) ? ((uint32_t *)out)[j] : (type == 1 ? out[j] : check_float_key(((float *)out)[j]));
+			}
+			qsort(out, k, sizeof(uint64_t), check_compare_u64);
+			if (k && memcmp(out, &gold[n - k], sizeof(uint64_t)*k) != 0) {
+				printf("Error in select topk type %d for k= %zu\n", type, k);
+				errors++;
+			}
+		}
+	}
+
+release:
+	free(keys32);
+	free(keys64);
+	free(floats);
+	free(gold);
+	free(out);
+	return errors;
+}
+
+
+// Keys with many duplicates, carried as tuples whose payload is the input
+// position, partitioned with 1, 7 and PARTITION_MAX_BITS bits directly and
+// through chunk counts and a separate scatter. Both have to equal a stable
+// counting sort by histogram_partition_of.
+#define CHECK_PARTITION_CHUNKS 5
+
+static int check_partition(const unsigned char *bytes, int n) {
+	const int bit_counts[] = { 1, 7, PARTITION_MAX_BITS };
+	histogram_tuple_t *in = (histogram_tuple_t *)malloc(sizeof(histogram_tuple_t)*(n > 0 ? n : 1));
+	histogram_tuple_t *gold = (histogram_tuple_t *)malloc(sizeof(histogram_tuple_t)*(n > 0 ? n : 1));
+	histogram_tuple_t *out = (histogram_tuple_t *)malloc(sizeof(histogram_tuple_t)*(n > 0 ? n : 1));
+	uint64_t *keys = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	uint64_t *keys_out = (uint64_t *)malloc(sizeof(uint64_t)*(n > 0 ? n : 1));
+	size_t *gold_offsets = (size_t *)malloc(sizeof(size_t)*(PARTITION_MAX_BINS + 1));
+	size_t *offsets = (size_t *)malloc(sizeof(size_t)*(PARTITION_MAX_BINS + 1));
+	uint64_t *chunk_counts = (uint64_t *)malloc(sizeof(uint64_t)*CHECK_PARTITION_CHUNKS*PARTITION_MAX_BINS);
+	int errors = 0;
+	if (!in || !gold || !out || !keys || !keys_out || !gold_offsets || !offsets || !chunk_counts) {
+		errors = check_alloc_failed("partition");
+		goto release;
+	}
+	for (int i = 0; i < n; i++) {
+		keys[i] = (uint64_t)bytes[i] << 8 | bytes[(i*5) % n];
+		in[i].key = keys[i];
+		in[i].payload = i;
+	}
+
+	for (int c = 0; c < 3; c++) {
+		int bits = bit_counts[c];
+		int parts = 1 << bits;
+		memset(gold_offsets, 0, sizeof(size_t)*(parts + 1));
+		for (int i = 0; i < n; i++) {
+			gold_offsets[histogram_partition_of(keys[i], bits) + 1]++;
+		}
+		for (int p = 0; p < parts; p++) {
+			gold_offsets[p + 1] += gold_offsets[p];
+		}
+		memcpy(offsets, gold_offsets, sizeof(size_t)*(parts + 1));
+		for (int i = 0; i < n; i++) {
+			gold[offsets[histogram_partition_of(keys[i], bits)]++] = in[i];
+		}
+
+		for (int path = 0; path < 2; path++) {
+			int err;
+			if (path == 0) {
+				err = histogram_partition_tuples(in, n, bits, out, offsets);
+				if (err == 0) {
+					err = histogram_partition_u64(keys, n, bits, keys_out, offsets);
+				}
+			} else {
+				err = histogram_partition_counts_tuples(in, n, bits, CHECK_PARTITION_CHUNKS, chunk_counts);
+				if (err == 0) {
+					err = histogram_partition_scatter_tuples(in, n, bits, CHECK_PARTITION_CHUNKS, chunk_counts, out, offsets);
+				}
+				if (err == 0) {
+					err = histogram_partition_counts_u64(keys, n, bits, CHECK_PARTITION_CHUNKS, chunk_counts);
+				}
+				if (err == 0) {
+					err = histogram_partition_scatter_u64(keys, n, bits, CHECK_PARTITION_CHUNKS, chunk_counts, keys_out, offsets);
+				}
+			}
+			if (err != 0) {
+				errors += check_alloc_failed("partition");
+				continue;
+			}
+			if (memcmp(offsets, gold_offsets, sizeof(size_t)*(parts + 1)) != 0) {
+				printf("Error in partition offsets with %d bits%s\n", bits, path ? " (chunk counts)" : "");
+				errors++;
+				continue;
+			}
+			for (int i = 0; i < n; i++) {
+				if (out[i].key != gold[i].key || out[i].payload != gold[i].payload || keys_out[i] != gold[i].key) {
+					printf("Error in partition with %d bits%s at element %d golden= %llu/%llu, hw=%llu/%llu\n", bits, path ? " (chunk counts)" : "", i,
+					       (unsigned long long)gold[i].key, (unsigned long long)gold[i].payload, (unsigned long long)out[i].key, (unsigned long long)out[i].payload);
+					errors++;
+					break;
+				}
+			}
+		}
+	}
+
+release:
+	free(in);
+	free(gold);
+	free(out);
+	free(keys);
+	free(keys_out);
+	free(gold_offsets);
+	free(offsets);
+	free(chunk_counts);
+	return errors;
+}
+
+
+// The fused histogram and moments of the host engine against a direct
+// count and integer sums; m2 against a two-pass long double reference.
+static int check_stats(const unsigned char *bytes, int n) {
+	BIN_DATA_TYPE gold[BIN_SIZE];
+	BIN_DATA_TYPE hw[BIN_SIZE];
+	histogram_stats_t stats;
+	uint64_t sum = 0, sumsq = 0;
+	int vmin = BIN_SIZE, vmax = -1;
+	int errors = 0;
+
+	memset(gold, 0, sizeof(gold));
+	for (int i = 0; i < n; i++) {
+		gold[bytes[i]]++;
+		sum += bytes[i];
+		sumsq += (uint64_t)bytes[i]*bytes[i];
+		vmin = bytes[i] < vmin ? bytes[i] : vmin;
+		vmax = bytes[i] > vmax ? bytes[i] : vmax;
+	}
+	long double mean = n ? (long double)sum/n : 0;
+	long double m2 = 0;
+	for (int i = 0; i < n; i++) {
+		m2 += (bytes[i] - mean)*(bytes[i] - mean);
+	}
+
+	histogram_cpu_stats(bytes, hw, n, &stats);
+	errors += check_bins("stats", gold, hw, BIN_SIZE);
+	if (n > 0 && (stats.count != (uint64_t)n || stats.min != vmin || stats.max != vmax || stats.sum != (double)sum ||
+	              stats.sumsq != (double)sumsq || fabsl(stats.mean - mean) > 1e-12L*mean || fabsl(stats.m2 - m2) > 1e-9L*m2)) {
+		printf("Error in host stats: golden count=%d min=%d max=%d sum=%llu m2=%.3Lf, hw=%llu %.0f %.0f %.0f %.3f\n", n, vmin, vmax,
+		       (unsigned long long)sum, m2, (unsigned long long)stats.count, stats.min, stats.max, stats.sum, stats.m2);
+		errors++;
+	}
+	return errors;
+}
+
+
+// Every rule on float data with NaNs and infinities, once with the bulk of
+// the data in range and once with far outliers that force a refine, and
+// on double data. The bins are recounted from the chosen layout; extremes,
+// NaN and infinity counts must be exact, and after a refine no finite
+// value may be left outside.
+static int check_autorange(const unsigned char *bytes, int n) {
+	float *values = (float *)malloc(sizeof(float)*(n > 0 ? n : 1));
+	double *wide = (double *)malloc(sizeof(double)*(n > 0 ? n : 1));
+	uint64_t *counts = (uint64_t *)malloc(sizeof(uint64_t)*AUTORANGE_MAX_BINS);
+	int errors = 0;
+	if (!values || !wide || !counts) {
+		errors = check_alloc_failed("autorange");
+		goto release;
+	}
+
+	for (int layout = 0; layout < 3; layout++) {
+		uint64_t nans = 0, infinities = 0;
+		double vmin = DBL_MAX, vmax = -DBL_MAX;
+		for (int i = 0; i < n; i++) {
+			double x = (bytes[i] - 100.0)*0.37 + (i % 7)*0.01;
+			if (i % 997 == 5) {
+				x = (i % 2) ? NAN : ((i % 3) ? INFINITY : -INFINITY);
+			} else if (layout == 1 && i % 50 == 3) {
+				x = (i % 4 == 1) ? 1e6 + i : -2e5 - i;
+			}
+			values[i] = (float)x;
+			wide[i] = (layout == 2) ? x*1e-300 : (double)values[i];
+			double v = wide[i];
+			nans += (v != v);
+			infinities += (v == INFINITY || v == -INFINITY);
+			if (v >= -DBL_MAX && v <= DBL_MAX) {
+				vmin = v < vmin ? v : vmin;
+				vmax = v > vmax ? v : vmax;
+			}
+		}
+
+		for (int rule = AUTORANGE_STURGES; rule <= AUTORANGE_FREEDMAN_DIACONIS; rule++) {
+			histogram_autorange_t h;
+			int err = (layout == 2) ? histogram_autorange_double(wide, n, rule, &h) : histogram_autorange_float(values, n, rule, &h);
+			if (err != 0) {
+				errors += check_alloc_failed("autorange");
+				continue;
+			}
+			uint64_t underflow = 0, overflow = 0;
+			memset(counts, 0, sizeof(uint64_t)*h.num_bins);
+			for (int i = 0; i < n; i++) {
+				double v = wide[i];
+				if (v != v) {
+					continue;
+				}
+				double pos = (v - h.lo)*(1.0/h.width);
+				if (pos < 0) {
+					underflow++;
+				} else if (!(pos < h.num_bins)) {
+					overflow++;
+				} else {
+					counts[(int)pos]++;
+				}
+			}
+			int bad = memcmp(counts, h.counts, sizeof(uint64_t)*h.num_bins) != 0 || h.underflow != underflow || h.overflow != overflow ||
+			          h.nans != nans || h.infinities != infinities || h.min != vmin || h.max != vmax ||
+			          h.num_bins < 1 || h.num_bins > AUTORANGE_MAX_BINS ||
+			          (h.passes == 2 && underflow + overflow != infinities) || (layout == 1 && h.passes != 2);
+			if (bad) {
+				printf("Error in autorange layout %d rule %d: golden under/over= %llu/%llu min= %g max= %g, hw=%llu/%llu %g %g (%d bins, %d passes)\n",
+				       layout, rule, (unsigned long long)underflow, (unsigned long long)overflow, vmin, vmax,
+				       (unsigned long long)h.underflow, (unsigned long long)h.overflow, h.min, h.max, h.num_bins, h.passes);
+				errors++;
+			}
+			histogram_autorange_release(&h);
+		}
+	}
+
+	{
+		histogram_autorange_t h;
+		if (histogram_autorange_float(values, n, AUTORANGE_FREEDMAN_DIACONIS + 1, &h) != -1) {
+			printf("Error in autorange: unknown rule accepted\n");
+			errors++;
+			histogram_autorange_release(&h);
+		}
+	}
+
+release:
+	free(values);
+	free(wide);
+	free(counts);
+	return errors;
+}
+
+
+typedef struct {
+	const BIN_DATA_TYPE *gold;
+	size_t               blocks_done;
+	int                  snapshots;
+	int                  exact;
+	int                  errors;
+} check_sample_t;
+
+// Every snapshot has to make progress, account for its elements and keep
+// the estimate inside its interval; the last one has to be exact.
+static int check_sample_snapshot(const histogram_sample_t *sample, void *ctx) {
+	check_sample_t *c = (check_sample_t *)ctx;
+	size_t tail = sample->data_size - sample->num_blocks*sample->block_size;
+	int bad = sample->blocks_done <= c->blocks_done && sample->num_blocks > 0;
+	bad |= sample->elements_done != tail + sample->blocks_done*sample->block_size;
+	for (int v = 0; v < BIN_SIZE; v++) {
+		bad |= !(sample->lower[v] <= sample->estimate[v] && sample->estimate[v] <= sample->upper[v]);
+		if (sample->exact) {
+			bad |= sample->estimate[v] != c->gold[v] || sample->lower[v] != c->gold[v] || sample->upper[v] != c->gold[v];
+		}
+	}
+	if (bad) {
+		printf("Error in sample at snapshot %d after %zu of %zu blocks\n", c->snapshots, sample->blocks_done, sample->num_blocks);
+		c->errors++;
+		return 1;
+	}
+	c->blocks_done = sample->blocks_done;
+	c->exact = sample->exact;
+	c->snapshots++;
+	return 0;
+}
+
+
+// Both visiting orders with small blocks and an incomplete last block,
+// refined to the end a few blocks at a time.
+#define CHECK_SAMPLE_BLOCK 4096
+
+static int check_sample(const unsigned char *bytes, int n) {
+	BIN_DATA_TYPE gold[BIN_SIZE];
+	int errors = 0;
+	int len = n - n % CHECK_SAMPLE_BLOCK - 1001;
+	if (len < 2*CHECK_SAMPLE_BLOCK) {
+		return 0;
+	}
+	memset(gold, 0, sizeof(gold));
+	for (int i = 0; i < len; i++) {
+		gold[bytes[i]]++;
+	}
+
+	for (int order = SAMPLE_RANDOM; order <= SAMPLE_STRIDED; order++) {
+		check_sample_t c = { gold, 0, 0, 0, 0 };
+		int err = histogram_sample_progressive(bytes, len, CHECK_SAMPLE_BLOCK, order, 12345, 7, check_sample_snapshot, &c);
+		size_t num_blocks = len/CHECK_SAMPLE_BLOCK;
+		if (err != 0 || c.errors || c.blocks_done != num_blocks || !c.exact) {
+			printf("Error in sample order %d: returned %d after %zu of %zu blocks\n", order, err, c.blocks_done, num_blocks);
+			errors += 1 + c.errors;
+		}
+	}
+
+	histogram_sample_t sample;
+	if (histogram_sample_init(&sample, bytes, len, CHECK_SAMPLE_BLOCK, SAMPLE_STRIDED + 1, 1) != -1) {
+		printf("Error in sample: unknown order accepted\n");
+		errors++;
+	}
+	return errors;
+}
+
+
+// Runs of every length from 1 to a few thousand, so that blocks dominated
+// by runs, mixed blocks and runs across block and thread boundaries all
+// occur; histogram_cpu on an unaligned start and histogram_cpu_block on a
+// slice, against a direct count.
+static int check_runs(const unsigned char *bytes, int n) {
+	unsigned char *runs = (unsigned char *)malloc(n > 0 ? n : 1);
+	BIN_DATA_TYPE gold[BIN_SIZE];
+	BIN_DATA_TYPE hw[BIN_SIZE];
+	int errors = 0;
+	if (!runs) {
+		return check_alloc_failed("runs");
+	}
+	for (int i = 0, k = 0; i < n; k++) {
+		int len = (k % 3 == 0) ? 1 + bytes[k % n] % 4 : (k % 3 == 1 ? 1 + bytes[k % n]*13 : 16*(1 + k % 5));
+		for (int j = 0; j < len && i < n; j++, i++) {
+			runs[i] = bytes[k % n];
+		}
+	}
+
+	int len = n > 1 ? n - 1 : 0;
+	memset(gold, 0, sizeof(gold));
+	for (int i = 1; i <= len; i++) {
+		gold[runs[i]]++;
+	}
+	histogram_cpu(runs + 1, hw, len);
+	errors += check_bins("runs", gold, hw, BIN_SIZE);
+
+	int slice = len < 100000 ? len : 100000;
+	memset(gold, 0, sizeof(gold));
+	for (int i = 1; i <= slice; i++) {
+		gold[runs[i]]++;
+	}
+	histogram_cpu_block(runs + 1, hw, slice);
+	errors += check_bins("runs block", gold, hw, BIN_SIZE);
+
+	free(runs);
+	return errors;
+}
+
+
+int histogram_check(const INPUT_DATA_TYPE *Data, int data_size) {
+	int n = data_size < CHECK_LENGTH ? data_size : CHECK_LENGTH;
+	unsigned char *bytes = check_bytes(Data, n);
+	if (!bytes) {
+		return check_alloc_failed("checks");
+	}
+
+	int errors = 0;
+	errors += check_edges(bytes, n);
+	errors += check_weighted(bytes, n);
+	errors += check_joint(bytes, n);
+	errors += check_multichannel(bytes, n);
+	errors += check_equalize(bytes, n);
+	errors += check_window(bytes, n);
+	errors += check_tiled(bytes, n);
+	errors += check_integral(bytes, n);
+	errors += check_image(bytes, n);
+	errors += check_masked(bytes, n);
+	errors += check_hash(bytes, n);
+	errors += check_sparse(bytes, n);
+	errors += check_topk(bytes, n);
+	errors += check_hdr(bytes, n);
+	errors += check_query(bytes, n);
+	errors += check_distance(bytes, n);
+	errors += check_entropy(bytes, n);
+	errors += check_ngram(bytes, n);
+	errors += check_radix(bytes, n);
+	errors += check_select(bytes, n);
+	errors += check_partition(bytes, n);
+	errors += check_stats(bytes, n);
+	errors += check_autorange(bytes, n);
+	errors += check_sample(bytes, n);
+	errors += check_runs(bytes, n);
+
+	free(bytes);
+	return errors;
+}
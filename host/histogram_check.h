@@ -0,0 +1,41 @@
+/* File: histogram_check.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_check.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_CHECK_h__
+#define __HISTOGRAM_CHECK_h__
+
+#include "histogram.h"
+
+// Golden checks of the host histogram engines, each against a naive
+// reference, run by main next to the device histogram_golden comparison.
+// The inputs are derived from the first CHECK_LENGTH elements of Data.
+// Mismatches are printed as "Error in <engine> ..." lines; returns their
+// number.
+#define CHECK_LENGTH (1 << 20)
+
+int histogram_check(const INPUT_DATA_TYPE *Data, int data_size);
+
+#endif // __HISTOGRAM_CHECK_h__
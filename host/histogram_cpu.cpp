@@ -0,0 +1,470 @@
+/* File: histogram_cpu.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_cpu.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Run-length fast path: elements per uniformity test, per kernel decision,
+// and uniformity tests per decision.
+#define CPU_RLE_VECTOR 16
+#define CPU_RLE_BLOCK  4096
+#define CPU_RLE_PROBES 8
+
+
+int histogram_cpu_threads() {
+#ifdef _OPENMP
+	return omp_get_max_threads();
+#else
+	return 1;
+#endif
+}
+
+
+int histogram_cpu_thread_range(size_t data_size, size_t *begin, size_t *end) {
+#ifdef _OPENMP
+	int tid = omp_get_thread_num();
+	int nth = omp_get_num_threads();
+#else
+	int tid = 0;
+	int nth = 1;
+#endif
+	*begin = data_size*tid/nth;
+	*end   = data_size*(tid+1)/nth;
+	return tid;
+}
+
+
+// Counts length elements into the HISTOGRAM_CPU_COPIES sub-histograms at h.
+static void cpu_count_general(const INPUT_DATA_TYPE *Data, size_t length, unsigned int *h) {
+	size_t i = 0;
+
+	// eight elements per 64-bit load, spread over the four copies
+	for (; i + 8 <= length; i += 8) {
+		uint64_t w;
+		memcpy(&w, &Data[i], sizeof(w));
+		h[0*BIN_SIZE + (w       & 0xFF)]++;
+		h[1*BIN_SIZE + ((w>> 8) & 0xFF)]++;
+		h[2*BIN_SIZE + ((w>>16) & 0xFF)]++;
+		h[3*BIN_SIZE + ((w>>24) & 0xFF)]++;
+		h[0*BIN_SIZE + ((w>>32) & 0xFF)]++;
+		h[1*BIN_SIZE + ((w>>40) & 0xFF)]++;
+		h[2*BIN_SIZE + ((w>>48) & 0xFF)]++;
+		h[3*BIN_SIZE + ((w>>56)       )]++;
+	}
+	for (; i < length; i++) {
+		h[(unsigned int)Data[i]]++;
+	}
+}
+
+
+// True if the CPU_RLE_VECTOR elements at p all equal p[0].
+static inline int cpu_uniform(const INPUT_DATA_TYPE *p) {
+#ifdef __SSE2__
+	__m128i v = _mm_loadu_si128((const __m128i *)p);
+	__m128i b = _mm_set1_epi8((char)p[0]);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(v, b)) == 0xFFFF;
+#else
+	uint64_t w0, w1;
+	memcpy(&w0, p, sizeof(w0));
+	memcpy(&w1, p + 8, sizeof(w1));
+	uint64_t b = (uint64_t)p[0]*0x0101010101010101ULL;
+	return ((w0 ^ b) | (w1 ^ b)) == 0;
+#endif
+}
+
+
+// Run-length kernel: vectors equal to the current run only extend it, and
+// the run is added to its bin in one step when it ends. Vectors that are not
+// uniform are counted element by element.
+static void cpu_count_rle(const INPUT_DATA_TYPE *Data, size_t length, unsigned int *h) {
+	size_t i = 0;
+	size_t run = 0;
+	unsigned int value = 0;
+
+	for (; i + CPU_RLE_VECTOR <= length; i += CPU_RLE_VECTOR) {
+		const INPUT_DATA_TYPE *p = &Data[i];
+		if (cpu_uniform(p)) {
+			if (run && (unsigned int)p[0] == value) {
+				run += CPU_RLE_VECTOR;
+				continue;
+			}
+			h[value] += (unsigned int)run;
+			value = (unsigned int)p[0];
+			run = CPU_RLE_VECTOR;
+			continue;
+		}
+		cpu_count_general(p, CPU_RLE_VECTOR, h);
+	}
+	h[value] += (unsigned int)run;
+	cpu_count_general(&Data[i], length - i, h);
+}
+
+
+// Picks a kernel per CPU_RLE_BLOCK elements: CPU_RLE_PROBES vectors spread
+// over the block are tested for uniformity, and the run-length kernel is used
+// if at least half of them are. A single equal value in a row costs the
+// general kernel a serialised increment per element; the probes cost a few
+// compares per block.
+static void cpu_count(const INPUT_DATA_TYPE *Data, size_t length, unsigned int *h) {
+	size_t i = 0;
+
+	for (; i + CPU_RLE_BLOCK <= length; i += CPU_RLE_BLOCK) {
+		const INPUT_DATA_TYPE *block = &Data[i];
+		int uniform = 0;
+		for (int k = 0; k < CPU_RLE_PROBES; k++) {
+			uniform += cpu_uniform(&block[k*(CPU_RLE_BLOCK/CPU_RLE_PROBES)]);
+		}
+		if (2*uniform >= CPU_RLE_PROBES) {
+			cpu_count_rle(block, CPU_RLE_BLOCK, h);
+		} else {
+			cpu_count_general(block, CPU_RLE_BLOCK, h);
+		}
+	}
+	cpu_count_general(&Data[i], length - i, h);
+}
+
+
+// Bin-wise reduction of all copies of all threads, vectorised by the compiler.
+static void cpu_reduce(const unsigned int *partial, int num_threads, BIN_DATA_TYPE *Histogram) {
+	for (int j = 0; j < BIN_SIZE; j++) {
+		Histogram[j] = 0;
+	}
+	for (int c = 0; c < num_threads*HISTOGRAM_CPU_COPIES; c++) {
+		const unsigned int *h = partial + (size_t)c*BIN_SIZE;
+		for (int j = 0; j < BIN_SIZE; j++) {
+			Histogram[j] += h[j];
+		}
+	}
+}
+
+
+// Sub-histograms for *num_threads threads. If they cannot be allocated the
+// caller runs on one thread in `fallback` (HISTOGRAM_CPU_COPIES*BIN_SIZE
+// counters on its stack), so counting never fails for lack of memory.
+static unsigned int *cpu_partials(int *num_threads, unsigned int *fallback) {
+	unsigned int *partial = (unsigned int *)calloc((size_t)*num_threads*HISTOGRAM_CPU_COPIES*BIN_SIZE, sizeof(unsigned int));
+	if (!partial) {
+		*num_threads = 1;
+		memset(fallback, 0, sizeof(unsigned int)*HISTOGRAM_CPU_COPIES*BIN_SIZE);
+		partial = fallback;
+	}
+	return partial;
+}
+
+
+static void cpu_partials_release(unsigned int *partial, const unsigned int *fallback) {
+	if (partial != fallback) {
+		free(partial);
+	}
+}
+
+
+void histogram_cpu(const INPUT_DATA_TYPE *Data, BIN_DATA_TYPE *Histogram, size_t data_size) {
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int fallback[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+	unsigned int *partial = cpu_partials(&num_threads, fallback);
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+		cpu_count(&Data[begin], end - begin, partial + (size_t)tid*HISTOGRAM_CPU_COPIES*BIN_SIZE);
+	}
+
+	cpu_reduce(partial, num_threads, Histogram);
+	cpu_partials_release(partial, fallback);
+}
+
+
+void histogram_cpu_block(const INPUT_DATA_TYPE *Data, BIN_DATA_TYPE *Histogram, size_t length) {
+	unsigned int h[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+	memset(h, 0, sizeof(h));
+	cpu_count(Data, length, h);
+	cpu_reduce(h, 1, Histogram);
+}
+
+
+void histogram_stats_merge(histogram_stats_t *a, const histogram_stats_t *b) {
+	if (b->count == 0) {
+		return;
+	}
+	if (a->count == 0) {
+		*a = *b;
+		return;
+	}
+	double na = (double)a->count;
+	double nb = (double)b->count;
+	double n = na + nb;
+	double delta = b->mean - a->mean;
+	a->mean  += delta*nb/n;
+	a->m2    += b->m2 + delta*delta*na*nb/n;
+	a->sum   += b->sum;
+	a->sumsq += b->sumsq;
+	a->min    = b->min < a->min ? b->min : a->min;
+	a->max    = b->max > a->max ? b->max : a->max;
+	a->count += b->count;
+}
+
+
+// Moments of `copies` sub-histograms of BIN_SIZE bins laid out back to back.
+static void cpu_stats(const unsigned int *h, int copies, histogram_stats_t *stats) {
+	uint64_t counts[BIN_SIZE];
+	uint64_t n = 0;
+	double sum = 0;
+	double sumsq = 0;
+	int lo = -1;
+	int hi = -1;
+	for (int b = 0; b < BIN_SIZE; b++) {
+		uint64_t c = 0;
+		for (int k = 0; k < copies; k++) {
+			c += h[k*BIN_SIZE + b];
+		}
+		counts[b] = c;
+		if (c) {
+			lo = lo < 0 ? b : lo;
+			hi = b;
+		}
+		n     += c;
+		sum   += (double)c*b;
+		sumsq += (double)c*b*b;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	if (n == 0) {
+		return;
+	}
+	stats->count = n;
+	stats->min   = lo;
+	stats->max   = hi;
+	stats->sum   = sum;
+	stats->sumsq = sumsq;
+	stats->mean  = sum/(double)n;
+	for (int b = lo; b <= hi; b++) {
+		double d = b - stats->mean;
+		stats->m2 += (double)counts[b]*d*d;
+	}
+}
+
+
+void histogram_stats_from_histogram(const BIN_DATA_TYPE *Histogram, histogram_stats_t *stats) {
+	unsigned int h[BIN_SIZE];
+	for (int b = 0; b < BIN_SIZE; b++) {
+		h[b] = (unsigned int)Histogram[b];
+	}
+	cpu_stats(h, 1, stats);
+}
+
+
+void histogram_stats_from_sums(const int64_t *Sums, histogram_stats_t *stats) {
+	memset(stats, 0, sizeof(*stats));
+	if (Sums[0] <= 0) {
+		return;
+	}
+	stats->count = (uint64_t)Sums[0];
+	stats->min   = (double)Sums[1];
+	stats->max   = (double)Sums[2];
+	stats->sum   = (double)Sums[3];
+	stats->sumsq = (double)Sums[4];
+	stats->mean  = stats->sum/(double)stats->count;
+	// integer sums are exact, so the textbook form only loses the rounding
+	// of the final subtraction; long double keeps it from going negative
+	long double m2 = (long double)Sums[4] - (long double)Sums[3]*(long double)Sums[3]/(long double)Sums[0];
+	stats->m2 = m2 > 0 ? (double)m2 : 0.0;
+}
+
+
+void histogram_cpu_stats(const INPUT_DATA_TYPE *Data, BIN_DATA_TYPE *Histogram, size_t data_size, histogram_stats_t *stats) {
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int fallback[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+	histogram_stats_t fallback_stats;
+	unsigned int *partial = cpu_partials(&num_threads, fallback);
+	histogram_stats_t *thread_stats = (histogram_stats_t *)calloc(num_threads, sizeof(histogram_stats_t));
+	if (!thread_stats) {
+		// one thread, all on the stack
+		cpu_partials_release(partial, fallback);
+		num_threads = 1;
+		memset(fallback, 0, sizeof(fallback));
+		partial = fallback;
+		thread_stats = &fallback_stats;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+		unsigned int *h = partial + (size_t)tid*HISTOGRAM_CPU_COPIES*BIN_SIZE;
+		cpu_count(&Data[begin], end - begin, h);
+		cpu_stats(h, HISTOGRAM_CPU_COPIES, &thread_stats[tid]);
+	}
+
+	cpu_reduce(partial, num_threads, Histogram);
+	memset(stats, 0, sizeof(*stats));
+	for (int t = 0; t < num_threads; t++) {
+		histogram_stats_merge(stats, &thread_stats[t]);
+	}
+	if (thread_stats != &fallback_stats) {
+		free(thread_stats);
+	}
+	cpu_partials_release(partial, fallback);
+}
+
+
+int histogram_cpu_image(const histogram_image_t *image, BIN_DATA_TYPE *Histogram) {
+
+	if (image->width < 0 || image->height < 0 || image->pitch < image->width) {
+		return -1;
+	}
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int fallback[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+	unsigned int *partial = cpu_partials(&num_threads, fallback);
+
+	// rows are split between threads and read in place through the pitch
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range((size_t)image->height, &begin, &end);
+		unsigned int *h = partial + (size_t)tid*HISTOGRAM_CPU_COPIES*BIN_SIZE;
+		for (size_t y = begin; y < end; y++) {
+			cpu_count(image->base + y*image->pitch, (size_t)image->width, h);
+		}
+	}
+
+	cpu_reduce(partial, num_threads, Histogram);
+	cpu_partials_release(partial, fallback);
+	return 0;
+}
+
+
+// Counts the elements of Data[0, 64) selected by bits.
+static inline void cpu_count_bits(const INPUT_DATA_TYPE *Data, uint64_t bits, unsigned int *h) {
+	if (bits == ~(uint64_t)0) {
+		cpu_count_general(Data, 64, h);
+		return;
+	}
+	int c = 0;
+	while (bits) {
+		int k = __builtin_ctzll(bits);
+		h[c*BIN_SIZE + (unsigned int)Data[k]]++;
+		c = (c + 1) & (HISTOGRAM_CPU_COPIES - 1);
+		bits &= bits - 1;
+	}
+}
+
+
+void histogram_cpu_masked(const INPUT_DATA_TYPE *Data, const unsigned char *Mask, BIN_DATA_TYPE *Histogram, size_t data_size) {
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int fallback[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+	unsigned int *partial = cpu_partials(&num_threads, fallback);
+	size_t num_groups = data_size/64;
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(num_groups, &begin, &end);
+		unsigned int *h = partial + (size_t)tid*HISTOGRAM_CPU_COPIES*BIN_SIZE;
+
+		for (size_t g = begin; g < end; g++) {
+			const unsigned char *m = &Mask[64*g];
+			uint64_t bits = 0;
+#ifdef __SSE2__
+			const __m128i zero = _mm_setzero_si128();
+			for (int k = 0; k < 4; k++) {
+				__m128i v = _mm_loadu_si128((const __m128i *)&m[16*k]);
+				uint64_t rejected = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+				bits |= (~rejected & 0xFFFF) << (16*k);
+			}
+#else
+			for (int k = 0; k < 64; k++) {
+				bits |= (uint64_t)(m[k] != 0) << k;
+			}
+#endif
+			if (bits) {
+				cpu_count_bits(&Data[64*g], bits, h);
+			}
+		}
+		if (tid == 0) {
+			for (size_t i = 64*num_groups; i < data_size; i++) {
+				h[(unsigned int)Data[i]] += (Mask[i] != 0);
+			}
+		}
+	}
+
+	cpu_reduce(partial, num_threads, Histogram);
+	cpu_partials_release(partial, fallback);
+}
+
+
+void histogram_cpu_bitmask(const INPUT_DATA_TYPE *Data, const uint64_t *Bits, BIN_DATA_TYPE *Histogram, size_t data_size) {
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int fallback[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+	unsigned int *partial = cpu_partials(&num_threads, fallback);
+	size_t num_groups = data_size/64;
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(num_groups, &begin, &end);
+		unsigned int *h = partial + (size_t)tid*HISTOGRAM_CPU_COPIES*BIN_SIZE;
+
+		for (size_t g = begin; g < end; g++) {
+			if (Bits[g]) {
+				cpu_count_bits(&Data[64*g], Bits[g], h);
+			}
+		}
+		if (tid == 0) {
+			for (size_t i = 64*num_groups; i < data_size; i++) {
+				h[(unsigned int)Data[i]] += (unsigned int)((Bits[i/64] >> (i%64)) & 1);
+			}
+		}
+	}
+
+	cpu_reduce(partial, num_threads, Histogram);
+	cpu_partials_release(partial, fallback);
+}
+
+
+void histogram_cpu_range(const INPUT_DATA_TYPE *Data, INPUT_DATA_TYPE lo, INPUT_DATA_TYPE hi, BIN_DATA_TYPE *Histogram, size_t data_size) {
+
+	histogram_cpu(Data, Histogram, data_size);
+	for (int j = 0; j < BIN_SIZE; j++) {
+		if (j < (int)lo || j > (int)hi) {
+			Histogram[j] = 0;
+		}
+	}
+}
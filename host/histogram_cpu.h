@@ -0,0 +1,111 @@
+/* File: histogram_cpu.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_cpu.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_CPU_h__
+#define __HISTOGRAM_CPU_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Host CPU engine. The counting kernel is scalar: 64-bit loads of eight
+// elements, one increment per element into interleaved sub-histograms,
+// OpenMP across threads. Vector instructions (SSE2) appear only in the
+// side paths: the run detection and the mask/bitmask group tests.
+
+// Number of replicated sub-histograms per thread. Consecutive elements go to
+// different copies so that runs of equal values do not serialise on one
+// counter (store-to-load forwarding stall).
+#define HISTOGRAM_CPU_COPIES 4
+
+// Two-dimensional input, e.g. a region of interest inside a larger frame:
+// width x height elements starting at base, rows pitch elements apart.
+typedef struct {
+	const INPUT_DATA_TYPE *base;
+	int width;
+	int height;
+	int pitch;
+} histogram_image_t;
+
+// Moments of the data, produced alongside a histogram. Per-thread moments
+// are merged with Chan et al.'s parallel formula, which keeps m2 accurate
+// where sumsq - sum*sum/count would cancel.
+typedef struct {
+	uint64_t count;
+	double   min;
+	double   max;
+	double   sum;
+	double   sumsq;
+	double   mean;
+	double   m2;          // sum of squared deviations; variance = m2/count
+} histogram_stats_t;
+
+// a += b
+void histogram_stats_merge(histogram_stats_t *a, const histogram_stats_t *b);
+// Exact moments of the data behind an 8-bit histogram, in O(BIN_SIZE).
+void histogram_stats_from_histogram(const BIN_DATA_TYPE *Histogram, histogram_stats_t *stats);
+// Moments from the STATS_WORDS sums written by compute_data_histogram_kernel.
+void histogram_stats_from_sums(const int64_t *Sums, histogram_stats_t *stats);
+
+// Number of host threads used by the CPU engine (OpenMP, 1 without it).
+int histogram_cpu_threads();
+
+// Called inside a parallel region: returns the calling thread's index and its
+// contiguous share [*begin, *end) of data_size elements.
+int histogram_cpu_thread_range(size_t data_size, size_t *begin, size_t *end);
+
+// Multi-threaded host version of compute_data_histogram_kernel.
+// Histogram must hold BIN_SIZE entries; it is overwritten. Blocks dominated
+// by runs of one value (borders, padding) are counted run by run.
+void histogram_cpu(const INPUT_DATA_TYPE *Data, BIN_DATA_TYPE *Histogram, size_t data_size);
+
+// Single-threaded count of one block, for callers that parallelise over
+// blocks themselves. Histogram is overwritten.
+void histogram_cpu_block(const INPUT_DATA_TYPE *Data, BIN_DATA_TYPE *Histogram, size_t length);
+
+// Fused variant: the histogram and the moments of the data in one pass.
+// Every thread derives its moments from its own sub-histograms, so the
+// counting loop is unchanged.
+void histogram_cpu_stats(const INPUT_DATA_TYPE *Data, BIN_DATA_TYPE *Histogram, size_t data_size, histogram_stats_t *stats);
+
+// Same for a pitched image, read in place without packing it first.
+// Returns 0 on success, -1 if the descriptor is invalid.
+int histogram_cpu_image(const histogram_image_t *image, BIN_DATA_TYPE *Histogram);
+
+// Filtered histograms, the filter fused into the counting loop.
+// Element i is counted if Mask[i] != 0, respectively if bit (i % 64) of
+// Bits[i / 64] is set. The data is taken in groups of 64 elements: a fully
+// rejected group is skipped and a fully accepted one counted without
+// per-element tests.
+void histogram_cpu_masked(const INPUT_DATA_TYPE *Data, const unsigned char *Mask, BIN_DATA_TYPE *Histogram, size_t data_size);
+void histogram_cpu_bitmask(const INPUT_DATA_TYPE *Data, const uint64_t *Bits, BIN_DATA_TYPE *Histogram, size_t data_size);
+
+// Only elements with lo <= Data[i] <= hi. The predicate is on the value
+// itself, so it selects whole bins: this is the unfiltered histogram with
+// the bins outside [lo, hi] cleared, no per-element test at all.
+void histogram_cpu_range(const INPUT_DATA_TYPE *Data, INPUT_DATA_TYPE lo, INPUT_DATA_TYPE hi, BIN_DATA_TYPE *Histogram, size_t data_size);
+
+#endif // __HISTOGRAM_CPU_h__
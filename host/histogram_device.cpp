@@ -0,0 +1,563 @@
+/* File: histogram_device.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_device.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_device.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+
+// Creates a pair of single work-item kernels (producer and consumer of a channel).
+static int device_create_kernels(cl_program program, const char *read_name, const char *compute_name,
+                                 cl_kernel *read_kernel, cl_kernel *compute_kernel) {
+	int err;
+
+	*read_kernel = clCreateKernel(program, read_name, &err);
+	if (!*read_kernel || err != CL_SUCCESS) {
+		printf("Error: Failed to create %s!\n", read_name);
+		return err;
+	}
+	*compute_kernel = clCreateKernel(program, compute_name, &err);
+	if (!*compute_kernel || err != CL_SUCCESS) {
+		printf("Error: Failed to create %s!\n", compute_name);
+		clReleaseKernel(*read_kernel);
+		return err;
+	}
+	return CL_SUCCESS;
+}
+
+
+// Enqueues both kernels of a channel pair and waits for them.
+static int device_run_kernels(cl_command_queue commands, cl_kernel read_kernel, cl_kernel compute_kernel) {
+	int err;
+	size_t global[1];
+	size_t local[1];
+
+	local[0]  = 1;
+	global[0] = 1;
+	err = clEnqueueNDRangeKernel(commands, read_kernel, 1, NULL, global, local, 0, NULL, NULL);
+	if (err) {
+		printf("Error: Failed to execute kernel! %d\n", err);
+		return err;
+	}
+	err = clEnqueueNDRangeKernel(commands, compute_kernel, 1, NULL, global, local, 0, NULL, NULL);
+	if (err) {
+		printf("Error: Failed to execute kernel! %d\n", err);
+		return err;
+	}
+	return clFinish(commands);
+}
+
+
+int histogram_device_joint(cl_context context, cl_command_queue commands, cl_program program,
+                           cl_mem d_A, cl_mem d_B, int data_size,
+                           histogram_joint_info_t *info, BIN_DATA_TYPE *Joint) {
+	int err;
+	cl_long sums[4];
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+	int write_joint = (Joint != NULL);
+
+	err = device_create_kernels(program, "read_pair_kernel", "compute_joint_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Joint = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(BIN_DATA_TYPE)*JOINT_BIN_SIZE*JOINT_BIN_SIZE, NULL, &err);
+	cl_mem d_Info  = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(sums), NULL, &err);
+	if (!d_Joint || !d_Info) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_A);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(cl_mem), &d_B);
+	err |= clSetKernelArg(read_kernel, 2, sizeof(int), &data_size);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(int), &data_size);
+	err |= clSetKernelArg(compute_kernel, 1, sizeof(int), &write_joint);
+	err |= clSetKernelArg(compute_kernel, 2, sizeof(cl_mem), &d_Joint);
+	err |= clSetKernelArg(compute_kernel, 3, sizeof(cl_mem), &d_Info);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set joint kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	err = clEnqueueReadBuffer(commands, d_Info, CL_TRUE, 0, sizeof(sums), sums, 0, NULL, NULL);
+	if (err == CL_SUCCESS) {
+		// H = log2(N) - sum(c*log2(c))/N, from the kernel's fixed-point sums
+		double total = (double)sums[0];
+		double scale = (total > 0) ? 1.0/(total*(double)(1 << JOINT_LOG_SHIFT)) : 0.0;
+		double log_total = (total > 0) ? log2(total) : 0.0;
+		info->entropy_a  = log_total - (double)sums[1]*scale;
+		info->entropy_b  = log_total - (double)sums[2]*scale;
+		info->entropy_ab = log_total - (double)sums[3]*scale;
+		info->mutual_information = info->entropy_a + info->entropy_b - info->entropy_ab;
+	}
+	if (err == CL_SUCCESS && Joint) {
+		err = clEnqueueReadBuffer(commands, d_Joint, CL_TRUE, 0, sizeof(BIN_DATA_TYPE)*JOINT_BIN_SIZE*JOINT_BIN_SIZE, Joint, 0, NULL, NULL);
+	}
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to read output array! %d\n", err);
+	}
+
+release:
+	if (d_Joint) clReleaseMemObject(d_Joint);
+	if (d_Info)  clReleaseMemObject(d_Info);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
+
+
+int histogram_device_multichannel(cl_context context, cl_command_queue commands, cl_program program,
+                                  cl_mem d_Pixels, int num_pixels, BIN_DATA_TYPE *Histograms) {
+	int err;
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+
+	err = device_create_kernels(program, "read_pixel_kernel", "compute_multichannel_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Histograms = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(BIN_DATA_TYPE)*4*BIN_SIZE, NULL, &err);
+	if (!d_Histograms) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Pixels);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(int), &num_pixels);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(int), &num_pixels);
+	err |= clSetKernelArg(compute_kernel, 1, sizeof(cl_mem), &d_Histograms);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set multichannel kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	err = clEnqueueReadBuffer(commands, d_Histograms, CL_TRUE, 0, sizeof(BIN_DATA_TYPE)*4*BIN_SIZE, Histograms, 0, NULL, NULL);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to read output array! %d\n", err);
+	}
+
+release:
+	if (d_Histograms) clReleaseMemObject(d_Histograms);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
+
+
+int histogram_device_equalize(cl_context context, cl_command_queue commands, cl_program program,
+                              cl_mem d_Data, cl_mem d_Histogram, cl_mem d_Out, int data_size,
+                              cl_event wait_event) {
+	int err;
+	size_t global[1];
+	size_t local[1];
+
+	(void)context;
+	cl_kernel equalize_kernel = clCreateKernel(program, "equalize_data_kernel", &err);
+	if (!equalize_kernel || err != CL_SUCCESS) {
+		printf("Error: Failed to create equalize_data_kernel!\n");
+		return err;
+	}
+
+	err  = clSetKernelArg(equalize_kernel, 0, sizeof(cl_mem), &d_Data);
+	err |= clSetKernelArg(equalize_kernel, 1, sizeof(cl_mem), &d_Histogram);
+	err |= clSetKernelArg(equalize_kernel, 2, sizeof(cl_mem), &d_Out);
+	err |= clSetKernelArg(equalize_kernel, 3, sizeof(int), &data_size);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set equalize kernel arguments! %d\n", err);
+		clReleaseKernel(equalize_kernel);
+		return err;
+	}
+
+	local[0]  = 1;
+	global[0] = 1;
+	err = clEnqueueNDRangeKernel(commands, equalize_kernel, 1, NULL, global, local,
+	                             wait_event ? 1 : 0, wait_event ? &wait_event : NULL, NULL);
+	if (err) {
+		printf("Error: Failed to execute kernel! %d\n", err);
+	} else {
+		err = clFinish(commands);
+	}
+
+	clReleaseKernel(equalize_kernel);
+	return err;
+}
+
+
+int histogram_device_tiled(cl_context context, cl_command_queue commands, cl_program program,
+                           cl_mem d_Image, int width, int height, int pitch,
+                           int tiles_x, int tiles_y, BIN_DATA_TYPE *Histograms) {
+	int err;
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+	size_t hist_size = sizeof(BIN_DATA_TYPE)*tiles_x*tiles_y*BIN_SIZE;
+
+	if (tiles_x < 1 || tiles_x > TILED_MAX_TILES_X || tiles_y < 1 || tiles_y > height || tiles_x > width || pitch < width) {
+		printf("Error: Invalid tile grid %d x %d!\n", tiles_x, tiles_y);
+		return CL_INVALID_VALUE;
+	}
+
+	err = device_create_kernels(program, "read_image_kernel", "compute_tiled_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Histograms = clCreateBuffer(context, CL_MEM_WRITE_ONLY, hist_size, NULL, &err);
+	if (!d_Histograms) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Image);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(int), &width);
+	err |= clSetKernelArg(read_kernel, 2, sizeof(int), &height);
+	err |= clSetKernelArg(read_kernel, 3, sizeof(int), &pitch);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(int), &width);
+	err |= clSetKernelArg(compute_kernel, 1, sizeof(int), &height);
+	err |= clSetKernelArg(compute_kernel, 2, sizeof(int), &tiles_x);
+	err |= clSetKernelArg(compute_kernel, 3, sizeof(int), &tiles_y);
+	err |= clSetKernelArg(compute_kernel, 4, sizeof(cl_mem), &d_Histograms);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set tiled kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	err = clEnqueueReadBuffer(commands, d_Histograms, CL_TRUE, 0, hist_size, Histograms, 0, NULL, NULL);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to read output array! %d\n", err);
+	}
+
+release:
+	if (d_Histograms) clReleaseMemObject(d_Histograms);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
+
+
+int histogram_device_write_image(cl_command_queue commands, cl_mem d_Data, const histogram_image_t *image) {
+	int err;
+	size_t buffer_origin[3] = { 0, 0, 0 };
+	size_t host_origin[3]   = { 0, 0, 0 };
+	size_t region[3];
+
+	region[0] = sizeof(INPUT_DATA_TYPE)*image->width;
+	region[1] = image->height;
+	region[2] = 1;
+	err = clEnqueueWriteBufferRect(commands, d_Data, CL_TRUE, buffer_origin, host_origin, region,
+	                               sizeof(INPUT_DATA_TYPE)*image->width, 0,
+	                               sizeof(INPUT_DATA_TYPE)*image->pitch, 0,
+	                               image->base, 0, NULL, NULL);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to write image region! %d\n", err);
+	}
+	return err;
+}
+
+
+int histogram_device_image(cl_context context, cl_command_queue commands, cl_program program,
+                           cl_mem d_Frame, int offset, int width, int height, int pitch,
+                           cl_mem d_Histogram, BIN_DATA_TYPE *Histogram, histogram_stats_t *stats) {
+	int err;
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+	int data_size = width*height;
+	int bin_size = BIN_SIZE;
+
+	if (width < 0 || height < 0 || pitch < width) {
+		printf("Error: Invalid image region!\n");
+		return CL_INVALID_VALUE;
+	}
+
+	err = device_create_kernels(program, "read_data_kernel", "compute_data_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Own   = d_Histogram ? NULL : clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(BIN_DATA_TYPE)*BIN_SIZE, NULL, &err);
+	cl_mem d_Stats = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_long)*STATS_WORDS, NULL, &err);
+	if (!d_Histogram) {
+		d_Histogram = d_Own;
+	}
+	if (!d_Histogram || !d_Stats) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Frame);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(int), &offset);
+	err |= clSetKernelArg(read_kernel, 2, sizeof(int), &width);
+	err |= clSetKernelArg(read_kernel, 3, sizeof(int), &height);
+	err |= clSetKernelArg(read_kernel, 4, sizeof(int), &pitch);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(int), &data_size);
+	err |= clSetKernelArg(compute_kernel, 1, sizeof(int), &bin_size);
+	err |= clSetKernelArg(compute_kernel, 2, sizeof(cl_mem), &d_Histogram);
+	err |= clSetKernelArg(compute_kernel, 3, sizeof(cl_mem), &d_Stats);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set image kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	if (Histogram) {
+		err = clEnqueueReadBuffer(commands, d_Histogram, CL_TRUE, 0, sizeof(BIN_DATA_TYPE)*BIN_SIZE, Histogram, 0, NULL, NULL);
+		if (err != CL_SUCCESS) {
+			printf("Error: Failed to read output array! %d\n", err);
+			goto release;
+		}
+	}
+	if (stats) {
+		cl_long sums[STATS_WORDS];
+		err = clEnqueueReadBuffer(commands, d_Stats, CL_TRUE, 0, sizeof(cl_long)*STATS_WORDS, sums, 0, NULL, NULL);
+		if (err != CL_SUCCESS) {
+			printf("Error: Failed to read output array! %d\n", err);
+			goto release;
+		}
+		int64_t words[STATS_WORDS];
+		for (int w = 0; w < STATS_WORDS; w++) {
+			words[w] = (int64_t)sums[w];
+		}
+		histogram_stats_from_sums(words, stats);
+	}
+
+release:
+	if (d_Own) clReleaseMemObject(d_Own);
+	if (d_Stats) clReleaseMemObject(d_Stats);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
+
+
+int histogram_device_masked(cl_context context, cl_command_queue commands, cl_program program,
+                            cl_mem d_Data, cl_mem d_Mask, int lo, int hi, int data_size,
+                            cl_mem d_Histogram, BIN_DATA_TYPE *Histogram) {
+	int err;
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+	int use_mask = (d_Mask != NULL);
+	cl_mem mask = use_mask ? d_Mask : d_Data;
+
+	err = device_create_kernels(program, "read_masked_data_kernel", "compute_masked_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Own = d_Histogram ? NULL : clCreateBuffer(context, CL_MEM_READ_WRITE, sizeof(BIN_DATA_TYPE)*BIN_SIZE, NULL, &err);
+	if (!d_Histogram) {
+		d_Histogram = d_Own;
+	}
+	if (!d_Histogram) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Data);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(cl_mem), &mask);
+	err |= clSetKernelArg(read_kernel, 2, sizeof(int), &use_mask);
+	err |= clSetKernelArg(read_kernel, 3, sizeof(int), &lo);
+	err |= clSetKernelArg(read_kernel, 4, sizeof(int), &hi);
+	err |= clSetKernelArg(read_kernel, 5, sizeof(int), &data_size);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(cl_mem), &d_Histogram);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set masked kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	if (Histogram) {
+		err = clEnqueueReadBuffer(commands, d_Histogram, CL_TRUE, 0, sizeof(BIN_DATA_TYPE)*BIN_SIZE, Histogram, 0, NULL, NULL);
+		if (err != CL_SUCCESS) {
+			printf("Error: Failed to read output array! %d\n", err);
+		}
+	}
+
+release:
+	if (d_Own) clReleaseMemObject(d_Own);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
+
+
+int histogram_device_digits(cl_context context, cl_command_queue commands, cl_program program,
+                            cl_mem d_Keys, int num_keys, int key_bytes, uint64_t *Digits) {
+	int err;
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+	int words_per_key = key_bytes/4;
+	int num_words = num_keys*words_per_key;
+	int num_bins = 4*words_per_key*BIN_SIZE;
+	BIN_DATA_TYPE *counts = NULL;
+
+	if (key_bytes != 4 && key_bytes != 8) {
+		return CL_INVALID_VALUE;
+	}
+
+	err = device_create_kernels(program, "read_key_kernel", "compute_digit_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Digits = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(BIN_DATA_TYPE)*num_bins, NULL, &err);
+	if (!d_Digits) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Keys);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(int), &num_words);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(int), &num_words);
+	err |= clSetKernelArg(compute_kernel, 1, sizeof(int), &words_per_key);
+	err |= clSetKernelArg(compute_kernel, 2, sizeof(cl_mem), &d_Digits);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set digit kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	counts = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*num_bins);
+	if (!counts) {
+		err = CL_OUT_OF_HOST_MEMORY;
+		goto release;
+	}
+	err = clEnqueueReadBuffer(commands, d_Digits, CL_TRUE, 0, sizeof(BIN_DATA_TYPE)*num_bins, counts, 0, NULL, NULL);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to read output array! %d\n", err);
+		goto release;
+	}
+	for (int j = 0; j < num_bins; j++) {
+		Digits[j] = (uint64_t)(unsigned int)counts[j];
+	}
+
+release:
+	free(counts);
+	if (d_Digits) clReleaseMemObject(d_Digits);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
+
+
+int histogram_device_partition(cl_context context, cl_command_queue commands, cl_program program,
+                               cl_mem d_Keys, int num_keys, int key_stride, int bits, int num_chunks,
+                               uint64_t *ChunkCounts) {
+	int err;
+	cl_kernel read_kernel;
+	cl_kernel compute_kernel;
+	int num_bins = num_chunks << bits;
+	BIN_DATA_TYPE *counts = NULL;
+
+	if (bits < 1 || bits > PARTITION_MAX_BITS || num_chunks < 1) {
+		return CL_INVALID_VALUE;
+	}
+
+	err = device_create_kernels(program, "read_partition_key_kernel", "compute_partition_histogram_kernel", &read_kernel, &compute_kernel);
+	if (err != CL_SUCCESS) {
+		return err;
+	}
+
+	cl_mem d_Counts = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(BIN_DATA_TYPE)*num_bins, NULL, &err);
+	if (!d_Counts) {
+		printf("Error: Failed to allocate device memory!\n");
+		err = CL_MEM_OBJECT_ALLOCATION_FAILURE;
+		goto release;
+	}
+
+	err  = clSetKernelArg(read_kernel, 0, sizeof(cl_mem), &d_Keys);
+	err |= clSetKernelArg(read_kernel, 1, sizeof(int), &key_stride);
+	err |= clSetKernelArg(read_kernel, 2, sizeof(int), &num_keys);
+	err |= clSetKernelArg(compute_kernel, 0, sizeof(int), &num_keys);
+	err |= clSetKernelArg(compute_kernel, 1, sizeof(int), &num_chunks);
+	err |= clSetKernelArg(compute_kernel, 2, sizeof(int), &bits);
+	err |= clSetKernelArg(compute_kernel, 3, sizeof(cl_mem), &d_Counts);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to set partition kernel arguments! %d\n", err);
+		goto release;
+	}
+
+	err = device_run_kernels(commands, read_kernel, compute_kernel);
+	if (err != CL_SUCCESS) {
+		goto release;
+	}
+
+	counts = (BIN_DATA_TYPE *)malloc(sizeof(BIN_DATA_TYPE)*num_bins);
+	if (!counts) {
+		err = CL_OUT_OF_HOST_MEMORY;
+		goto release;
+	}
+	err = clEnqueueReadBuffer(commands, d_Counts, CL_TRUE, 0, sizeof(BIN_DATA_TYPE)*num_bins, counts, 0, NULL, NULL);
+	if (err != CL_SUCCESS) {
+		printf("Error: Failed to read output array! %d\n", err);
+		goto release;
+	}
+	for (int j = 0; j < num_bins; j++) {
+		ChunkCounts[j] = (uint64_t)(unsigned int)counts[j];
+	}
+
+release:
+	free(counts);
+	if (d_Counts) clReleaseMemObject(d_Counts);
+	clReleaseKernel(read_kernel);
+	clReleaseKernel(compute_kernel);
+	return err;
+}
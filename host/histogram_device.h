@@ -0,0 +1,111 @@
+/* File: histogram_device.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_device.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_DEVICE_h__
+#define __HISTOGRAM_DEVICE_h__
+
+#include <stdint.h>
+#include <CL/opencl.h>
+#include "histogram.h"
+#include "histogram_cpu.h"
+#include "histogram_joint.h"
+
+// Host-side launchers for the kernel variants in device/histogram.cl.
+// The context, command queue and program are the ones set up in main().
+// Each launcher creates its kernels, runs them to completion and returns
+// CL_SUCCESS or the failing OpenCL error code.
+
+
+// Joint histogram of d_A and d_B (data_size unsigned chars each) with the
+// fused entropy reduction; both are quantised to JOINT_BIN_BITS bits. The
+// kernel returns fixed-point sums of float rounded c*log2(c) terms and the
+// entropies are formed from them in double on the host. The JOINT_BIN_SIZE^2
+// histogram is read back only if Joint is not NULL.
+int histogram_device_joint(cl_context context, cl_command_queue commands, cl_program program,
+                           cl_mem d_A, cl_mem d_B, int data_size,
+                           histogram_joint_info_t *info, BIN_DATA_TYPE *Joint);
+
+// Per-channel histograms of num_pixels RGBA pixels (uchar4) held in d_Pixels.
+// Histograms receives 4 x BIN_SIZE bins; RGB data has to be padded to RGBA.
+int histogram_device_multichannel(cl_context context, cl_command_queue commands, cl_program program,
+                                  cl_mem d_Pixels, int num_pixels, BIN_DATA_TYPE *Histograms);
+
+// Histogram equalisation pass chained after compute_data_histogram_kernel:
+// d_Histogram is the histogram it produced, which the kernel reads, so it
+// has to be CL_MEM_READ_WRITE (main's d_Histogram, or a buffer handed to
+// histogram_device_image/masked), and wait_event its completion event (or
+// NULL). d_Data is remapped into d_Out on the device, so the image
+// is transferred only once; read d_Out back when the result is needed.
+int histogram_device_equalize(cl_context context, cl_command_queue commands, cl_program program,
+                              cl_mem d_Data, cl_mem d_Histogram, cl_mem d_Out, int data_size,
+                              cl_event wait_event);
+
+// Tile histograms of a width x height image (row pitch in elements) held in
+// d_Image, same grid and layout as histogram_tiled(). tiles_x is limited to
+// TILED_MAX_TILES_X.
+int histogram_device_tiled(cl_context context, cl_command_queue commands, cl_program program,
+                           cl_mem d_Image, int width, int height, int pitch,
+                           int tiles_x, int tiles_y, BIN_DATA_TYPE *Histograms);
+
+// Copies the region of interest described by image into d_Data as a packed
+// width x height block with a rectangular DMA (clEnqueueWriteBufferRect),
+// without packing it on the host first.
+int histogram_device_write_image(cl_command_queue commands, cl_mem d_Data, const histogram_image_t *image);
+
+// Histogram of a width x height region at element offset inside d_Frame,
+// rows pitch elements apart. read_data_kernel walks the rows in place, so a
+// frame already on the device is not copied again per region. The moments
+// of the region computed by the same kernel go to stats unless it is NULL.
+// If d_Histogram is not NULL the histogram is written there (a
+// CL_MEM_READ_WRITE buffer of BIN_SIZE bins) and stays on the device for
+// histogram_device_equalize; Histogram may then be NULL to skip the read back.
+int histogram_device_image(cl_context context, cl_command_queue commands, cl_program program,
+                           cl_mem d_Frame, int offset, int width, int height, int pitch,
+                           cl_mem d_Histogram, BIN_DATA_TYPE *Histogram, histogram_stats_t *stats);
+
+// Histogram of the elements of d_Data with lo <= value <= hi and, if d_Mask
+// is not NULL, a non-zero mask byte. The filter runs in the read kernel, so
+// rejected elements are never sent to the histogram kernel. d_Histogram and
+// Histogram as for histogram_device_image.
+int histogram_device_masked(cl_context context, cl_command_queue commands, cl_program program,
+                            cl_mem d_Data, cl_mem d_Mask, int lo, int hi, int data_size,
+                            cl_mem d_Histogram, BIN_DATA_TYPE *Histogram);
+
+// All byte-digit histograms of num_keys keys of key_bytes (4 or 8) bytes
+// held in d_Keys, in the layout of histogram_radix_digits_u32/u64, so the
+// counting phase of histogram_radix_sort_u32/u64 can run on the device.
+int histogram_device_digits(cl_context context, cl_command_queue commands, cl_program program,
+                            cl_mem d_Keys, int num_keys, int key_bytes, uint64_t *Digits);
+
+// Partition histograms of num_chunks equal chunks of num_keys keys held in
+// d_Keys, key_stride 64-bit words apart (1 for keys, 2 for histogram_tuple_t),
+// for histogram_partition_scatter_u64/tuples with the same num_chunks, so
+// the device does the counting and the host only the scatter.
+int histogram_device_partition(cl_context context, cl_command_queue commands, cl_program program,
+                               cl_mem d_Keys, int num_keys, int key_stride, int bits, int num_chunks,
+                               uint64_t *ChunkCounts);
+
+#endif // __HISTOGRAM_DEVICE_h__
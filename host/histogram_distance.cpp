@@ -0,0 +1,496 @@
+/* File: histogram_distance.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_distance.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_distance.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+// The row kernels are written once against a small vector layer: 8 lanes
+// with AVX2, 4 with SSE2, 1 otherwise. Rows are padded to DISTANCE_ROW_ALIGN
+// bins, so every loop runs over whole vectors.
+#if defined(__AVX2__)
+
+#define DIST_WIDTH 8
+typedef __m256 dist_v;
+
+static inline dist_v v_set(float x)               { return _mm256_set1_ps(x); }
+static inline dist_v v_add(dist_v a, dist_v b)    { return _mm256_add_ps(a, b); }
+static inline dist_v v_sub(dist_v a, dist_v b)    { return _mm256_sub_ps(a, b); }
+static inline dist_v v_mul(dist_v a, dist_v b)    { return _mm256_mul_ps(a, b); }
+static inline dist_v v_div(dist_v a, dist_v b)    { return _mm256_div_ps(a, b); }
+static inline dist_v v_min(dist_v a, dist_v b)    { return _mm256_min_ps(a, b); }
+static inline dist_v v_max(dist_v a, dist_v b)    { return _mm256_max_ps(a, b); }
+static inline dist_v v_sqrt(dist_v a)             { return _mm256_sqrt_ps(a); }
+static inline dist_v v_abs(dist_v a)              { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+static inline dist_v v_load(const float *p)       { return _mm256_loadu_ps(p); }
+static inline dist_v v_load(const uint16_t *p) {
+	__m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+	return _mm256_mul_ps(_mm256_cvtepi32_ps(x), _mm256_set1_ps(1.0f/DISTANCE_QUANT_SCALE));
+}
+static inline dist_v v_lut(const float *lut, const uint16_t *p) {
+	__m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+	return _mm256_i32gather_ps(lut, x, 4);
+}
+static inline float v_sum(dist_v a) {
+	__m128 x = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+	x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+// Inclusive prefix sum across the lanes plus carry; carry becomes the last lane.
+static inline dist_v v_scan(dist_v x, dist_v *carry) {
+	x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 4)));
+	x = _mm256_add_ps(x, _mm256_castsi256_ps(_mm256_slli_si256(_mm256_castps_si256(x), 8)));
+	__m256 low = _mm256_shuffle_ps(x, x, 0xFF);
+	x = _mm256_add_ps(x, _mm256_permute2f128_ps(low, low, 0x08));
+	x = _mm256_add_ps(x, *carry);
+	__m256 last = _mm256_shuffle_ps(x, x, 0xFF);
+	*carry = _mm256_permute2f128_ps(last, last, 0x11);
+	return x;
+}
+// log2 of positive, normal x; split into exponent and mantissa in
+// [sqrt(1/2), sqrt(2)), then log2(m) = 2/ln2 * atanh((m-1)/(m+1)).
+static inline dist_v v_log2(dist_v x) {
+	__m256i bits = _mm256_castps_si256(x);
+	__m256i e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+	__m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+	__m256 big = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+	m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+	__m256 ef = _mm256_add_ps(_mm256_cvtepi32_ps(e), _mm256_and_ps(big, _mm256_set1_ps(1.0f)));
+	__m256 y = _mm256_div_ps(_mm256_sub_ps(m, _mm256_set1_ps(1.0f)), _mm256_add_ps(m, _mm256_set1_ps(1.0f)));
+	__m256 y2 = _mm256_mul_ps(y, y);
+	__m256 p = _mm256_add_ps(_mm256_mul_ps(y2, _mm256_set1_ps(1.0f/7)), _mm256_set1_ps(1.0f/5));
+	p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(1.0f/3));
+	p = _mm256_add_ps(_mm256_mul_ps(p, y2), _mm256_set1_ps(1.0f));
+	return _mm256_add_ps(ef, _mm256_mul_ps(_mm256_mul_ps(p, y), _mm256_set1_ps(2.88539008f)));
+}
+
+#elif defined(__SSE2__)
+
+#define DIST_WIDTH 4
+typedef __m128 dist_v;
+
+static inline dist_v v_set(float x)               { return _mm_set1_ps(x); }
+static inline dist_v v_add(dist_v a, dist_v b)    { return _mm_add_ps(a, b); }
+static inline dist_v v_sub(dist_v a, dist_v b)    { return _mm_sub_ps(a, b); }
+static inline dist_v v_mul(dist_v a, dist_v b)    { return _mm_mul_ps(a, b); }
+static inline dist_v v_div(dist_v a, dist_v b)    { return _mm_div_ps(a, b); }
+static inline dist_v v_min(dist_v a, dist_v b)    { return _mm_min_ps(a, b); }
+static inline dist_v v_max(dist_v a, dist_v b)    { return _mm_max_ps(a, b); }
+static inline dist_v v_sqrt(dist_v a)             { return _mm_sqrt_ps(a); }
+static inline dist_v v_abs(dist_v a)              { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+static inline dist_v v_load(const float *p)       { return _mm_loadu_ps(p); }
+static inline dist_v v_load(const uint16_t *p) {
+	__m128i x = _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+	return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f/DISTANCE_QUANT_SCALE));
+}
+static inline dist_v v_lut(const float *lut, const uint16_t *p) {
+	return _mm_setr_ps(lut[p[0]], lut[p[1]], lut[p[2]], lut[p[3]]);
+}
+static inline float v_sum(dist_v x) {
+	x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+	x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+	return _mm_cvtss_f32(x);
+}
+static inline dist_v v_scan(dist_v x, dist_v *carry) {
+	x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+	x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+	x = _mm_add_ps(x, *carry);
+	*carry = _mm_shuffle_ps(x, x, 0xFF);
+	return x;
+}
+static inline dist_v v_log2(dist_v x) {
+	__m128i bits = _mm_castps_si128(x);
+	__m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+	__m128 big = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+	m = _mm_or_ps(_mm_andnot_ps(big, m), _mm_and_ps(big, _mm_mul_ps(m, _mm_set1_ps(0.5f))));
+	__m128 ef = _mm_add_ps(_mm_cvtepi32_ps(e), _mm_and_ps(big, _mm_set1_ps(1.0f)));
+	__m128 y = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+	__m128 y2 = _mm_mul_ps(y, y);
+	__m128 p = _mm_add_ps(_mm_mul_ps(y2, _mm_set1_ps(1.0f/7)), _mm_set1_ps(1.0f/5));
+	p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f/3));
+	p = _mm_add_ps(_mm_mul_ps(p, y2), _mm_set1_ps(1.0f));
+	return _mm_add_ps(ef, _mm_mul_ps(_mm_mul_ps(p, y), _mm_set1_ps(2.88539008f)));
+}
+
+#else
+
+#define DIST_WIDTH 1
+typedef float dist_v;
+
+static inline dist_v v_set(float x)               { return x; }
+static inline dist_v v_add(dist_v a, dist_v b)    { return a + b; }
+static inline dist_v v_sub(dist_v a, dist_v b)    { return a - b; }
+static inline dist_v v_mul(dist_v a, dist_v b)    { return a * b; }
+static inline dist_v v_div(dist_v a, dist_v b)    { return a / b; }
+static inline dist_v v_min(dist_v a, dist_v b)    { return a < b ? a : b; }
+static inline dist_v v_max(dist_v a, dist_v b)    { return a > b ? a : b; }
+static inline dist_v v_sqrt(dist_v a)             { return sqrtf(a); }
+static inline dist_v v_abs(dist_v a)              { return fabsf(a); }
+static inline dist_v v_load(const float *p)       { return *p; }
+static inline dist_v v_load(const uint16_t *p)    { return *p*(1.0f/DISTANCE_QUANT_SCALE); }
+static inline dist_v v_lut(const float *lut, const uint16_t *p) { return lut[*p]; }
+static inline float  v_sum(dist_v a)              { return a; }
+static inline dist_v v_scan(dist_v x, dist_v *carry) { *carry += x; return *carry; }
+static inline dist_v v_log2(dist_v x)             { return log2f(x); }
+
+#endif
+
+
+// Query prepared once per call: normalised, plus the per-metric terms.
+typedef struct {
+	int    stride;
+	float *q;          // normalised query
+	float *aux;        // sqrt(q) for Bhattacharyya
+	float  q_log_q;    // sum q log2 q for KL
+} dist_query_t;
+
+// log2(v/DISTANCE_QUANT_SCALE + DISTANCE_KL_EPSILON) for every uint16 v:
+// the KL kernel looks the stored rows up instead of evaluating the log.
+static float dist_log_lut[65536];
+static int   dist_log_lut_ready = 0;
+
+static void dist_init_log_lut() {
+	#pragma omp critical(histogram_distance_lut)
+	{
+		if (!dist_log_lut_ready) {
+			for (int v = 0; v < 65536; v++) {
+				dist_log_lut[v] = log2f(v/DISTANCE_QUANT_SCALE + DISTANCE_KL_EPSILON);
+			}
+			dist_log_lut_ready = 1;
+		}
+	}
+}
+
+
+static inline dist_v dist_log_row(const float *row)    { return v_log2(v_add(v_load(row), v_set(DISTANCE_KL_EPSILON))); }
+static inline dist_v dist_log_row(const uint16_t *row) { return v_lut(dist_log_lut, row); }
+
+
+template <int M, typename R>
+static float dist_row(const dist_query_t *dq, const R *row) {
+	const float *q = dq->q;
+	dist_v acc = v_set(0.0f);
+	dist_v carry = v_set(0.0f);
+
+	for (int i = 0; i < dq->stride; i += DIST_WIDTH) {
+		dist_v p = v_load(&row[i]);
+		if (M == DISTANCE_CHI_SQUARE) {
+			dist_v d = v_sub(p, v_load(&q[i]));
+			dist_v s = v_max(v_add(p, v_load(&q[i])), v_set(1e-30f));
+			acc = v_add(acc, v_div(v_mul(d, d), s));
+		} else if (M == DISTANCE_INTERSECTION) {
+			acc = v_add(acc, v_min(p, v_load(&q[i])));
+		} else if (M == DISTANCE_BHATTACHARYYA) {
+			acc = v_add(acc, v_mul(v_sqrt(p), v_load(&dq->aux[i])));
+		} else if (M == DISTANCE_KL) {
+			acc = v_add(acc, v_mul(v_load(&q[i]), dist_log_row(&row[i])));
+		} else {
+			acc = v_add(acc, v_abs(v_scan(v_sub(p, v_load(&q[i])), &carry)));
+		}
+	}
+
+	float s = v_sum(acc);
+	if (M == DISTANCE_INTERSECTION) {
+		return 1.0f - s;
+	}
+	if (M == DISTANCE_BHATTACHARYYA) {
+		return s < 1.0f ? sqrtf(1.0f - s) : 0.0f;
+	}
+	if (M == DISTANCE_KL) {
+		return dq->q_log_q - s;
+	}
+	return s;
+}
+
+
+typedef float (*dist_row_fn)(const dist_query_t *dq, const void *row);
+
+template <int M, typename R>
+static float dist_row_any(const dist_query_t *dq, const void *row) {
+	return dist_row<M, R>(dq, (const R *)row);
+}
+
+template <typename R>
+static dist_row_fn dist_select(int metric) {
+	switch (metric) {
+	case DISTANCE_CHI_SQUARE:    return dist_row_any<DISTANCE_CHI_SQUARE, R>;
+	case DISTANCE_INTERSECTION:  return dist_row_any<DISTANCE_INTERSECTION, R>;
+	case DISTANCE_BHATTACHARYYA: return dist_row_any<DISTANCE_BHATTACHARYYA, R>;
+	case DISTANCE_KL:            return dist_row_any<DISTANCE_KL, R>;
+	case DISTANCE_EMD:           return dist_row_any<DISTANCE_EMD, R>;
+	}
+	return NULL;
+}
+
+
+int histogram_distance_set_create(histogram_distance_set_t *s, int num_bins, size_t capacity, int quantized) {
+	if (num_bins < 1) {
+		return -1;
+	}
+	s->num_bins  = num_bins;
+	s->stride    = (num_bins + DISTANCE_ROW_ALIGN - 1)/DISTANCE_ROW_ALIGN*DISTANCE_ROW_ALIGN;
+	s->quantized = quantized;
+	s->count     = 0;
+	s->capacity  = capacity;
+	s->rows      = NULL;
+	s->qrows     = NULL;
+	if (quantized) {
+		s->qrows = (uint16_t *)malloc(sizeof(uint16_t)*s->stride*(capacity ? capacity : 1));
+		return s->qrows ? 0 : -2;
+	}
+	s->rows = (float *)malloc(sizeof(float)*s->stride*(capacity ? capacity : 1));
+	return s->rows ? 0 : -2;
+}
+
+
+void histogram_distance_set_release(histogram_distance_set_t *s) {
+	free(s->rows);
+	free(s->qrows);
+	s->rows  = NULL;
+	s->qrows = NULL;
+}
+
+
+// Normalised copy of Histogram, zero padded to stride. Returns the count sum.
+static double dist_normalise(const BIN_DATA_TYPE *Histogram, int num_bins, int stride, float *out) {
+	double sum = 0;
+	for (int b = 0; b < num_bins; b++) {
+		sum += Histogram[b];
+	}
+	float scale = sum > 0 ? (float)(1.0/sum) : 0.0f;
+	for (int b = 0; b < num_bins; b++) {
+		out[b] = Histogram[b]*scale;
+	}
+	for (int b = num_bins; b < stride; b++) {
+		out[b] = 0.0f;
+	}
+	return sum;
+}
+
+
+int histogram_distance_set_load(histogram_distance_set_t *s, const BIN_DATA_TYPE *Matrix, size_t count) {
+	if (count > s->capacity - s->count) {
+		return -1;
+	}
+	int num_bins = s->num_bins;
+	int stride   = s->stride;
+	size_t first = s->count;
+
+	#pragma omp parallel for schedule(static)
+	for (long long r = 0; r < (long long)count; r++) {
+		const BIN_DATA_TYPE *h = &Matrix[(size_t)r*num_bins];
+		size_t row = first + (size_t)r;
+		if (!s->quantized) {
+			dist_normalise(h, num_bins, stride, &s->rows[row*stride]);
+		} else {
+			uint16_t *out = &s->qrows[row*stride];
+			double sum = 0;
+			for (int b = 0; b < num_bins; b++) {
+				sum += h[b];
+			}
+			float scale = sum > 0 ? (float)(DISTANCE_QUANT_SCALE/sum) : 0.0f;
+			for (int b = 0; b < num_bins; b++) {
+				out[b] = (uint16_t)(h[b]*scale + 0.5f);
+			}
+			for (int b = num_bins; b < stride; b++) {
+				out[b] = 0;
+			}
+		}
+	}
+	s->count += count;
+	return 0;
+}
+
+
+static int dist_prepare(const histogram_distance_set_t *s, const BIN_DATA_TYPE *Query, int metric, dist_query_t *dq, dist_row_fn *fn) {
+	*fn = s->quantized ? dist_select<uint16_t>(metric) : dist_select<float>(metric);
+	if (!*fn) {
+		return -1;
+	}
+	dq->stride = s->stride;
+	dq->q = (float *)malloc(sizeof(float)*2*s->stride);
+	if (!dq->q) {
+		return -2;
+	}
+	dq->aux = &dq->q[s->stride];
+	if (dist_normalise(Query, s->num_bins, s->stride, dq->q) <= 0) {
+		free(dq->q);
+		return -1;
+	}
+	dq->q_log_q = 0.0f;
+	for (int b = 0; b < s->stride; b++) {
+		dq->aux[b] = sqrtf(dq->q[b]);
+		if (dq->q[b] > 0) {
+			dq->q_log_q += dq->q[b]*log2f(dq->q[b]);
+		}
+	}
+	if (metric == DISTANCE_KL && s->quantized) {
+		dist_init_log_lut();
+	}
+	return 0;
+}
+
+
+static const void *dist_row_ptr(const histogram_distance_set_t *s, size_t r) {
+	if (s->quantized) {
+		return &s->qrows[r*s->stride];
+	}
+	return &s->rows[r*s->stride];
+}
+
+
+int histogram_distance_batch(const histogram_distance_set_t *s, const BIN_DATA_TYPE *Query, int metric, float *Distances) {
+	dist_query_t dq;
+	dist_row_fn fn;
+	int err = dist_prepare(s, Query, metric, &dq, &fn);
+	if (err) {
+		return err;
+	}
+
+	#pragma omp parallel for schedule(static)
+	for (long long r = 0; r < (long long)s->count; r++) {
+		Distances[r] = fn(&dq, dist_row_ptr(s, (size_t)r));
+	}
+
+	free(dq.q);
+	return 0;
+}
+
+
+// Orders by distance, then row index; a max-heap on this keeps the k best.
+static inline int dist_worse(const histogram_distance_match_t *a, const histogram_distance_match_t *b) {
+	return a->distance > b->distance || (a->distance == b->distance && a->index > b->index);
+}
+
+static void dist_sift_down(histogram_distance_match_t *heap, int size, int i) {
+	for (;;) {
+		int l = 2*i + 1;
+		int m = i;
+		if (l < size && dist_worse(&heap[l], &heap[m])) {
+			m = l;
+		}
+		if (l + 1 < size && dist_worse(&heap[l + 1], &heap[m])) {
+			m = l + 1;
+		}
+		if (m == i) {
+			return;
+		}
+		histogram_distance_match_t t = heap[i];
+		heap[i] = heap[m];
+		heap[m] = t;
+		i = m;
+	}
+}
+
+static void dist_heap_push(histogram_distance_match_t *heap, int *size, int k, histogram_distance_match_t m) {
+	if (*size < k) {
+		int i = (*size)++;
+		heap[i] = m;
+		while (i > 0 && dist_worse(&heap[i], &heap[(i - 1)/2])) {
+			histogram_distance_match_t t = heap[i];
+			heap[i] = heap[(i - 1)/2];
+			heap[(i - 1)/2] = t;
+			i = (i - 1)/2;
+		}
+	} else if (dist_worse(&heap[0], &m)) {
+		heap[0] = m;
+		dist_sift_down(heap, k, 0);
+	}
+}
+
+
+int histogram_distance_topk(const histogram_distance_set_t *s, const BIN_DATA_TYPE *Query, int metric, int k, histogram_distance_match_t *Matches) {
+	if (k < 1) {
+		return -1;
+	}
+	if ((size_t)k > s->count) {
+		k = (int)s->count;
+	}
+	if (k == 0) {
+		return 0;
+	}
+
+	dist_query_t dq;
+	dist_row_fn fn;
+	int err = dist_prepare(s, Query, metric, &dq, &fn);
+	if (err) {
+		return err;
+	}
+
+	int num_threads = histogram_cpu_threads();
+	histogram_distance_match_t *heaps = (histogram_distance_match_t *)malloc(sizeof(histogram_distance_match_t)*(size_t)k*num_threads);
+	int *sizes = (int *)calloc(num_threads, sizeof(int));
+	if (!heaps || !sizes) {
+		free(heaps);
+		free(sizes);
+		free(dq.q);
+		return -2;
+	}
+
+	// every thread keeps the k best of its share of rows
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(s->count, &begin, &end);
+		histogram_distance_match_t *heap = &heaps[(size_t)tid*k];
+		int size = 0;
+		for (size_t r = begin; r < end; r++) {
+			histogram_distance_match_t m = { r, fn(&dq, dist_row_ptr(s, r)) };
+			dist_heap_push(heap, &size, k, m);
+		}
+		sizes[tid] = size;
+	}
+
+	// merge the per-thread heaps, then pop them in reverse into Matches
+	histogram_distance_match_t *best = heaps;
+	int size = sizes[0];
+	for (int t = 1; t < num_threads; t++) {
+		for (int j = 0; j < sizes[t]; j++) {
+			dist_heap_push(best, &size, k, heaps[(size_t)t*k + j]);
+		}
+	}
+	for (int i = size - 1; i >= 0; i--) {
+		Matches[i] = best[0];
+		best[0] = best[i];
+		dist_sift_down(best, i, 0);
+	}
+
+	free(heaps);
+	free(sizes);
+	free(dq.q);
+	return size;
+}
@@ -0,0 +1,85 @@
+/* File: histogram_distance.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_distance.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_DISTANCE_h__
+#define __HISTOGRAM_DISTANCE_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Stored rows are padded with empty bins to a multiple of this.
+#define DISTANCE_ROW_ALIGN 16
+
+// Quantised rows hold round(p * DISTANCE_QUANT_SCALE) per bin.
+#define DISTANCE_QUANT_SCALE 65535.0f
+
+// Added to the stored probabilities inside the KL logarithm.
+#define DISTANCE_KL_EPSILON 1e-6f
+
+// Distances, 0 for identical histograms and growing with dissimilarity.
+// All histograms are normalised to unit sum first.
+#define DISTANCE_CHI_SQUARE    0   // sum (p-q)^2 / (p+q), in [0, 2]
+#define DISTANCE_INTERSECTION  1   // 1 - sum min(p, q)
+#define DISTANCE_BHATTACHARYYA 2   // sqrt(1 - sum sqrt(p*q))
+#define DISTANCE_KL            3   // KL(query || stored), in bits
+#define DISTANCE_EMD           4   // 1D earth mover's: sum |P - Q| over the CDFs, in bins
+#define DISTANCE_METRICS       5
+
+// Contiguous matrix of normalised histograms to compare queries against,
+// stored as float or, at half the memory traffic, as quantised uint16.
+typedef struct {
+	int       num_bins;
+	int       stride;      // num_bins rounded up to DISTANCE_ROW_ALIGN
+	int       quantized;
+	size_t    count;
+	size_t    capacity;
+	float    *rows;        // count x stride, when !quantized
+	uint16_t *qrows;       // count x stride, when quantized
+} histogram_distance_set_t;
+
+typedef struct {
+	size_t index;          // row in the set
+	float  distance;
+} histogram_distance_match_t;
+
+// Returns 0 on success, -1 for invalid arguments, -2 if allocation fails.
+int histogram_distance_set_create(histogram_distance_set_t *s, int num_bins, size_t capacity, int quantized);
+void histogram_distance_set_release(histogram_distance_set_t *s);
+
+// Normalises and appends count histograms of num_bins bins each, stored one
+// after another in Matrix. Returns 0, or -1 if the capacity is exceeded.
+int histogram_distance_set_load(histogram_distance_set_t *s, const BIN_DATA_TYPE *Matrix, size_t count);
+
+// Distance from Query (num_bins counts) to every row: Distances[count].
+// Returns 0, -1 for an unknown metric or empty query, -2 if allocation fails.
+int histogram_distance_batch(const histogram_distance_set_t *s, const BIN_DATA_TYPE *Query, int metric, float *Distances);
+
+// The k rows closest to Query, nearest first (ties by row index).
+// Returns the number of matches written, min(k, count), or -1/-2 as above.
+int histogram_distance_topk(const histogram_distance_set_t *s, const BIN_DATA_TYPE *Query, int metric, int k, histogram_distance_match_t *Matches);
+
+#endif // __HISTOGRAM_DISTANCE_h__
@@ -0,0 +1,169 @@
+/* File: histogram_edges.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_edges.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_edges.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+// In-order walk of the implicit tree: assigns the sorted keys to tree slots.
+static int edges_fill_tree(float *tree, int size, int k, const float *sorted, int next) {
+	if (k <= size) {
+		next = edges_fill_tree(tree, size, 2*k, sorted, next);
+		tree[k] = sorted[next++];
+		next = edges_fill_tree(tree, size, 2*k+1, sorted, next);
+	}
+	return next;
+}
+
+
+int histogram_edges_create(histogram_edges_t *edges_set, const float *edges, int num_edges) {
+
+	if (num_edges < 2) {
+		return -1;
+	}
+	for (int i = 0; i < num_edges; i++) {
+		if (!isfinite(edges[i]) || (i > 0 && !(edges[i] > edges[i-1]))) {
+			return -1;
+		}
+	}
+
+	int depth = 0;
+	while ((1 << depth) - 1 < num_edges) {
+		depth++;
+	}
+	int size = (1 << depth) - 1;
+
+	float *sorted = (float *)malloc(sizeof(float)*size);
+	float *tree   = (float *)malloc(sizeof(float)*(size+1));
+	if (!sorted || !tree) {
+		free(sorted);
+		free(tree);
+		return -2;
+	}
+	for (int i = 0; i < size; i++) {
+		sorted[i] = (i < num_edges) ? edges[i] : INFINITY;
+	}
+	tree[0] = INFINITY;
+	edges_fill_tree(tree, size, 1, sorted, 0);
+	free(sorted);
+
+	edges_set->num_bins  = num_edges - 1;
+	edges_set->depth     = depth;
+	edges_set->last_edge = edges[num_edges-1];
+	edges_set->tree      = tree;
+	return 0;
+}
+
+
+void histogram_edges_release(histogram_edges_t *edges_set) {
+	free(edges_set->tree);
+	edges_set->tree = NULL;
+}
+
+
+// Slot layout of the per-thread counters: 0 = below the first edge (or NaN),
+// 1..num_bins = bins, num_bins+1 = above the last edge.
+static inline int edges_slot(const histogram_edges_t *e, float x) {
+	int k = 1;
+	for (int l = 0; l < e->depth; l++) {
+		k = 2*k + (x >= e->tree[k]);
+	}
+	int r = k - (1 << e->depth) - (x == e->last_edge);
+	return (r < e->num_bins + 1) ? r : e->num_bins + 1;
+}
+
+
+int histogram_edges_compute(const histogram_edges_t *edges_set, const float *Data, size_t data_size, BIN_DATA_TYPE *Histogram) {
+
+	const histogram_edges_t *e = edges_set;
+	int num_threads = histogram_cpu_threads();
+	int slots = e->num_bins + 2;
+	unsigned int *partial = (unsigned int *)calloc((size_t)num_threads*HISTOGRAM_CPU_COPIES*slots, sizeof(unsigned int));
+	if (!partial) {
+		return -2;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+		unsigned int *h = partial + (size_t)tid*HISTOGRAM_CPU_COPIES*slots;
+		size_t i = begin;
+
+#ifdef __AVX2__
+		const __m256i one       = _mm256_set1_epi32(1);
+		const __m256i leaf_base = _mm256_set1_epi32(1 << e->depth);
+		const __m256i overflow  = _mm256_set1_epi32(e->num_bins + 1);
+		const __m256  last      = _mm256_set1_ps(e->last_edge);
+		int idx[8];
+
+		for (; i + 8 <= end; i += 8) {
+			__m256  x = _mm256_loadu_ps(&Data[i]);
+			__m256i k = one;
+			for (int l = 0; l < e->depth; l++) {
+				__m256  t  = _mm256_i32gather_ps(e->tree, k, 4);
+				__m256i ge = _mm256_castps_si256(_mm256_cmp_ps(x, t, _CMP_GE_OQ));
+				k = _mm256_sub_epi32(_mm256_add_epi32(k, k), ge);
+			}
+			__m256i eq = _mm256_castps_si256(_mm256_cmp_ps(x, last, _CMP_EQ_OQ));
+			__m256i r  = _mm256_add_epi32(_mm256_sub_epi32(k, leaf_base), eq);
+			r = _mm256_min_epi32(r, overflow);
+			_mm256_storeu_si256((__m256i *)idx, r);
+
+			h[0*slots + idx[0]]++;
+			h[1*slots + idx[1]]++;
+			h[2*slots + idx[2]]++;
+			h[3*slots + idx[3]]++;
+			h[0*slots + idx[4]]++;
+			h[1*slots + idx[5]]++;
+			h[2*slots + idx[6]]++;
+			h[3*slots + idx[7]]++;
+		}
+#endif
+		for (; i < end; i++) {
+			h[edges_slot(e, Data[i])]++;
+		}
+	}
+
+	for (int j = 0; j < e->num_bins; j++) {
+		Histogram[j] = 0;
+	}
+	for (int c = 0; c < num_threads*HISTOGRAM_CPU_COPIES; c++) {
+		const unsigned int *h = partial + (size_t)c*slots;
+		for (int j = 0; j < e->num_bins; j++) {
+			Histogram[j] += h[j+1];
+		}
+	}
+
+	free(partial);
+	return 0;
+}
@@ -0,0 +1,57 @@
+/* File: histogram_edges.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_edges.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_EDGES_h__
+#define __HISTOGRAM_EDGES_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Histogram over arbitrary, strictly increasing bin edges.
+// Bin i covers [edges[i], edges[i+1]); the last bin also includes its right
+// edge. Values outside the edges (and NaN) are not counted.
+//
+// The edges are stored once as a complete binary search tree in Eytzinger
+// (breadth-first) order, padded with +inf to 2^depth-1 keys. A lookup is then
+// a fixed number of branchless steps k = 2k + (x >= tree[k]), which maps
+// directly onto vector compare/gather, eight elements at a time with AVX2.
+typedef struct {
+	int    num_bins;
+	int    depth;
+	float  last_edge;
+	float *tree;        // 1-based, (1 << depth) entries
+} histogram_edges_t;
+
+// Builds the search tree. Returns 0 on success, -1 if the edges are not
+// finite and strictly increasing (or fewer than two), -2 if allocation fails.
+int histogram_edges_create(histogram_edges_t *edges_set, const float *edges, int num_edges);
+void histogram_edges_release(histogram_edges_t *edges_set);
+
+// Histogram must hold edges_set->num_bins entries; it is overwritten.
+// Returns 0 on success, -2 if allocation fails (Histogram untouched).
+int histogram_edges_compute(const histogram_edges_t *edges_set, const float *Data, size_t data_size, BIN_DATA_TYPE *Histogram);
+
+#endif // __HISTOGRAM_EDGES_h__
@@ -0,0 +1,212 @@
+/* File: histogram_entropy.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_entropy.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_entropy.h"
+#include "histogram_stream.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+// For a block of n bytes with counts c, H = log2(n) - sum(c*log2(c))/n.
+// The c*log2(c) terms come from a table indexed by count, so a block costs
+// its byte count plus 256 lookups. When the windows overlap by more than
+// half, the next window is reached by removing and adding stride bytes, and
+// the sum is updated with the table differences of the two touched bins.
+
+size_t histogram_block_entropy_count(uint64_t data_size, size_t block_size, size_t stride) {
+	if (block_size == 0 || stride == 0 || data_size < block_size) {
+		return 0;
+	}
+	return (size_t)((data_size - block_size)/stride + 1);
+}
+
+
+// table[c] = c*log2(c), 0 <= c <= n
+static double *entropy_table(size_t n) {
+	double *table = (double *)malloc(sizeof(double)*(n + 1));
+	if (table) {
+		table[0] = 0.0;
+		for (size_t c = 1; c <= n; c++) {
+			table[c] = (double)c*log2((double)c);
+		}
+	}
+	return table;
+}
+
+
+// Counts of one block, spread over HISTOGRAM_CPU_COPIES copies so that runs
+// of one byte value do not serialise on a counter.
+static void entropy_count(const unsigned char *Data, size_t length, unsigned int *counts) {
+	unsigned int h[HISTOGRAM_CPU_COPIES][BIN_SIZE];
+	memset(h, 0, sizeof(h));
+	size_t i = 0;
+	for (; i + HISTOGRAM_CPU_COPIES <= length; i += HISTOGRAM_CPU_COPIES) {
+		for (int c = 0; c < HISTOGRAM_CPU_COPIES; c++) {
+			h[c][Data[i + c]]++;
+		}
+	}
+	for (; i < length; i++) {
+		h[0][Data[i]]++;
+	}
+	for (int b = 0; b < BIN_SIZE; b++) {
+		unsigned int s = 0;
+		for (int c = 0; c < HISTOGRAM_CPU_COPIES; c++) {
+			s += h[c][b];
+		}
+		counts[b] = s;
+	}
+}
+
+
+static double entropy_sum(const unsigned int *counts, const double *table) {
+	double s = 0;
+	for (int b = 0; b < BIN_SIZE; b++) {
+		s += table[counts[b]];
+	}
+	return s;
+}
+
+
+// Blocks first..last-1 of Data.
+static void entropy_blocks(const unsigned char *Data, size_t block_size, size_t stride, const double *table, size_t first, size_t last, float *Entropy) {
+	unsigned int counts[BIN_SIZE];
+	double log_n = log2((double)block_size);
+	double inv_n = 1.0/(double)block_size;
+	int sliding = 2*stride < block_size;
+	double s = 0;
+
+	for (size_t k = first; k < last; k++) {
+		const unsigned char *block = &Data[k*stride];
+		if (k == first || !sliding) {
+			entropy_count(block, block_size, counts);
+			s = entropy_sum(counts, table);
+		} else {
+			const unsigned char *out = block - stride;
+			const unsigned char *in  = block + block_size - stride;
+			for (size_t i = 0; i < stride; i++) {
+				unsigned int c = counts[out[i]]--;
+				s += table[c - 1] - table[c];
+				c = counts[in[i]]++;
+				s += table[c + 1] - table[c];
+			}
+		}
+		double h = log_n - s*inv_n;
+		Entropy[k] = h > 0.0 ? (float)h : 0.0f;
+	}
+}
+
+
+int histogram_block_entropy(const unsigned char *Data, size_t data_size, size_t block_size, size_t stride, float *Entropy) {
+	if (block_size == 0 || stride == 0) {
+		return -1;
+	}
+	size_t num_blocks = histogram_block_entropy_count(data_size, block_size, stride);
+	if (num_blocks == 0) {
+		return 0;
+	}
+	double *table = entropy_table(block_size);
+	if (!table) {
+		return -2;
+	}
+
+	#pragma omp parallel
+	{
+		size_t first, last;
+		histogram_cpu_thread_range(num_blocks, &first, &last);
+		if (first < last) {
+			entropy_blocks(Data, block_size, stride, table, first, last, Entropy);
+		}
+	}
+
+	free(table);
+	return 0;
+}
+
+
+typedef struct {
+	histogram_entropy_map_t *map;
+	size_t next;               // first block not yet computed
+} entropy_stream_t;
+
+
+// Every chunk carries the last block_size bytes of the one before, so each
+// block lies whole inside the first chunk that reaches its end.
+static int entropy_chunk(const unsigned char *data, size_t size, uint64_t offset, void *ctx) {
+	entropy_stream_t *es = (entropy_stream_t *)ctx;
+	histogram_entropy_map_t *map = es->map;
+	uint64_t start = (uint64_t)es->next*map->stride;
+	if (start >= offset + size) {
+		return 0;
+	}
+	size_t skip = (size_t)(start - offset);
+	size_t count = histogram_block_entropy_count(size - skip, map->block_size, map->stride);
+	if (count > map->num_blocks - es->next) {
+		count = map->num_blocks - es->next;	// the file grew while streaming
+	}
+	if (count == 0) {
+		return 0;
+	}
+	size_t length = (count - 1)*map->stride + map->block_size;
+	int err = histogram_block_entropy(&data[skip], length, map->block_size, map->stride, &map->entropy[es->next]);
+	es->next += count;
+	return err;
+}
+
+
+int histogram_block_entropy_file(const char *filename, size_t block_size, size_t stride, histogram_entropy_map_t *map) {
+	map->block_size = block_size;
+	map->stride     = stride;
+	map->num_blocks = 0;
+	map->entropy    = NULL;
+	if (block_size == 0 || stride == 0) {
+		return -1;
+	}
+	int64_t file_size = histogram_stream_file_size(filename);
+	if (file_size < 0) {
+		return -1;
+	}
+	map->num_blocks = histogram_block_entropy_count((uint64_t)file_size, block_size, stride);
+	map->entropy = (float *)malloc(sizeof(float)*(map->num_blocks ? map->num_blocks : 1));
+	if (!map->entropy) {
+		return -2;
+	}
+
+	// whole strides per chunk, at least one block
+	size_t chunk = STREAM_CHUNK_SIZE/stride*stride;
+	if (chunk < block_size) {
+		chunk = (block_size + stride - 1)/stride*stride;
+	}
+	entropy_stream_t es = { map, 0 };
+	return histogram_stream_file(filename, chunk, block_size, entropy_chunk, &es);
+}
+
+
+void histogram_entropy_map_release(histogram_entropy_map_t *map) {
+	free(map->entropy);
+	map->entropy = NULL;
+}
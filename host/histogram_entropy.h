@@ -0,0 +1,59 @@
+/* File: histogram_entropy.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_entropy.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_ENTROPY_h__
+#define __HISTOGRAM_ENTROPY_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Entropy map of a byte stream: the Shannon entropy (bits per byte, 0..8) of
+// every block_size window starting at a multiple of stride. Values near 8 mark
+// compressed or encrypted regions. One float per block; the per-block
+// histograms are never stored.
+typedef struct {
+	size_t block_size;
+	size_t stride;
+	size_t num_blocks;
+	float *entropy;
+} histogram_entropy_map_t;
+
+// Number of whole blocks in data_size bytes.
+size_t histogram_block_entropy_count(uint64_t data_size, size_t block_size, size_t stride);
+
+// Entropy[num_blocks] for a buffer in memory.
+// Returns 0 on success, -1 if block_size or stride is 0, -2 if allocation fails.
+int histogram_block_entropy(const unsigned char *Data, size_t data_size, size_t block_size, size_t stride, float *Entropy);
+
+// Same for a file of any size, streamed in chunks. map->entropy is allocated
+// here and freed with histogram_entropy_map_release.
+// Returns 0, -1 for invalid arguments or a missing file, -2 on allocation or
+// read failure.
+int histogram_block_entropy_file(const char *filename, size_t block_size, size_t stride, histogram_entropy_map_t *map);
+void histogram_entropy_map_release(histogram_entropy_map_t *map);
+
+#endif // __HISTOGRAM_ENTROPY_h__
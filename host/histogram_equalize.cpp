@@ -0,0 +1,144 @@
+/* File: histogram_equalize.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_equalize.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_equalize.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#ifdef __SSSE3__
+#include <immintrin.h>
+#endif
+
+
+void histogram_equalize_lut(const BIN_DATA_TYPE *Histogram, BIN_DATA_TYPE *Cdf, unsigned char *Lut) {
+
+	BIN_DATA_TYPE cdf[BIN_SIZE];
+	BIN_DATA_TYPE running = 0;
+	BIN_DATA_TYPE cdf_min = 0;
+
+	for (int v = 0; v < BIN_SIZE; v++) {
+		running += Histogram[v];
+		cdf[v] = running;
+		if (cdf_min == 0) {
+			cdf_min = running;
+		}
+	}
+
+	if (running == cdf_min) {
+		for (int v = 0; v < BIN_SIZE; v++) {
+			Lut[v] = (unsigned char)v;
+		}
+	} else {
+		double scale = (double)(BIN_SIZE-1)/(double)(running - cdf_min);
+		for (int v = 0; v < BIN_SIZE; v++) {
+			double l = (cdf[v] > cdf_min) ? (cdf[v] - cdf_min)*scale + 0.5 : 0.0;
+			Lut[v] = (unsigned char)l;
+		}
+	}
+
+	if (Cdf) {
+		for (int v = 0; v < BIN_SIZE; v++) {
+			Cdf[v] = cdf[v];
+		}
+	}
+}
+
+
+void histogram_apply_lut(const unsigned char *In, unsigned char *Out, size_t data_size, const unsigned char *Lut) {
+
+	#pragma omp parallel
+	{
+		size_t begin, end;
+		histogram_cpu_thread_range(data_size, &begin, &end);
+		size_t i = begin;
+
+#if defined(__AVX512VBMI__)
+		// two 128-byte permutes, selected by the top bit of the index
+		const __m512i t0 = _mm512_loadu_si512((const void *)&Lut[0]);
+		const __m512i t1 = _mm512_loadu_si512((const void *)&Lut[64]);
+		const __m512i t2 = _mm512_loadu_si512((const void *)&Lut[128]);
+		const __m512i t3 = _mm512_loadu_si512((const void *)&Lut[192]);
+		for (; i + 64 <= end; i += 64) {
+			__m512i x  = _mm512_loadu_si512((const void *)&In[i]);
+			__m512i lo = _mm512_permutex2var_epi8(t0, x, t1);
+			__m512i hi = _mm512_permutex2var_epi8(t2, x, t3);
+			__m512i r  = _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), lo, hi);
+			_mm512_storeu_si512((void *)&Out[i], r);
+		}
+#elif defined(__AVX2__)
+		// 16 sub-tables of 16 entries. x ^ (h<<4) is below 16 only for high
+		// nibble h; the saturating +0x70 sets bit 7 otherwise so pshufb yields 0.
+		__m256i table[16];
+		for (int h = 0; h < 16; h++) {
+			table[h] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&Lut[16*h]));
+		}
+		const __m256i bias = _mm256_set1_epi8(0x70);
+		for (; i + 32 <= end; i += 32) {
+			__m256i x = _mm256_loadu_si256((const __m256i *)&In[i]);
+			__m256i r = _mm256_setzero_si256();
+			for (int h = 0; h < 16; h++) {
+				__m256i idx = _mm256_adds_epu8(_mm256_xor_si256(x, _mm256_set1_epi8((char)(h << 4))), bias);
+				r = _mm256_or_si256(r, _mm256_shuffle_epi8(table[h], idx));
+			}
+			_mm256_storeu_si256((__m256i *)&Out[i], r);
+		}
+#elif defined(__SSSE3__)
+		__m128i table[16];
+		for (int h = 0; h < 16; h++) {
+			table[h] = _mm_loadu_si128((const __m128i *)&Lut[16*h]);
+		}
+		const __m128i bias = _mm_set1_epi8(0x70);
+		for (; i + 16 <= end; i += 16) {
+			__m128i x = _mm_loadu_si128((const __m128i *)&In[i]);
+			__m128i r = _mm_setzero_si128();
+			for (int h = 0; h < 16; h++) {
+				__m128i idx = _mm_adds_epu8(_mm_xor_si128(x, _mm_set1_epi8((char)(h << 4))), bias);
+				r = _mm_or_si128(r, _mm_shuffle_epi8(table[h], idx));
+			}
+			_mm_storeu_si128((__m128i *)&Out[i], r);
+		}
+#endif
+		for (; i < end; i++) {
+			Out[i] = Lut[In[i]];
+		}
+	}
+}
+
+
+void histogram_equalize(const unsigned char *In, unsigned char *Out, size_t data_size, BIN_DATA_TYPE *Histogram) {
+
+	BIN_DATA_TYPE hist[BIN_SIZE];
+	unsigned char lut[BIN_SIZE];
+
+	histogram_cpu(In, hist, data_size);
+	histogram_equalize_lut(hist, NULL, lut);
+	histogram_apply_lut(In, Out, data_size, lut);
+
+	if (Histogram) {
+		for (int v = 0; v < BIN_SIZE; v++) {
+			Histogram[v] = hist[v];
+		}
+	}
+}
@@ -0,0 +1,47 @@
+/* File: histogram_equalize.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_equalize.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_EQUALIZE_h__
+#define __HISTOGRAM_EQUALIZE_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Cumulative histogram and equalisation look-up table of a BIN_SIZE
+// histogram: Lut[v] = round((Cdf[v] - Cdf_min)*(BIN_SIZE-1)/(total - Cdf_min)),
+// Cdf_min being the first non-zero entry. A constant image maps to itself.
+// Cdf may be NULL.
+void histogram_equalize_lut(const BIN_DATA_TYPE *Histogram, BIN_DATA_TYPE *Cdf, unsigned char *Lut);
+
+// Out[i] = Lut[In[i]] with vector table look-ups (vpermb with AVX-512 VBMI,
+// nibble-split pshufb with AVX2/SSSE3). Out may be the same array as In.
+void histogram_apply_lut(const unsigned char *In, unsigned char *Out, size_t data_size, const unsigned char *Lut);
+
+// Full pipeline: histogram_cpu, histogram_equalize_lut, histogram_apply_lut.
+// Histogram (BIN_SIZE entries) receives the input histogram if not NULL.
+void histogram_equalize(const unsigned char *In, unsigned char *Out, size_t data_size, BIN_DATA_TYPE *Histogram);
+
+#endif // __HISTOGRAM_EQUALIZE_h__
@@ -0,0 +1,145 @@
+/* File: histogram_grouped.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_grouped.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_grouped.h"
+#include "histogram_cpu.h"
+#include "histogram_hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static int grouped_dense(const INPUT_DATA_TYPE *Data, const unsigned int *Groups, size_t data_size,
+                         int num_groups, BIN_DATA_TYPE *Matrix) {
+
+	int num_threads = histogram_cpu_threads();
+	size_t cells = (size_t)num_groups*BIN_SIZE;
+	unsigned int *partial = (unsigned int *)calloc((size_t)num_threads*cells, sizeof(unsigned int));
+	if (!partial) {
+		return -2;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+		unsigned int *h = partial + tid*cells;
+
+		for (size_t i = begin; i < end; i++) {
+			unsigned int g = Groups[i];
+			if (g < (unsigned int)num_groups) {
+				h[(size_t)g*BIN_SIZE + (unsigned int)Data[i]]++;
+			}
+		}
+
+		#pragma omp barrier
+
+		// parallel merge over the matrix cells
+		#pragma omp for schedule(static)
+		for (long j = 0; j < (long)cells; j++) {
+			BIN_DATA_TYPE sum = 0;
+			for (int t = 0; t < num_threads; t++) {
+				sum += partial[t*cells + j];
+			}
+			Matrix[j] = sum;
+		}
+	}
+
+	free(partial);
+	return 0;
+}
+
+
+static int grouped_sparse(const INPUT_DATA_TYPE *Data, const unsigned int *Groups, size_t data_size,
+                          int num_groups, BIN_DATA_TYPE *Matrix) {
+
+	int num_threads = histogram_cpu_threads();
+	int num_parts = num_threads;
+	histogram_hash_t *tables = (histogram_hash_t *)calloc((size_t)num_threads*num_parts, sizeof(histogram_hash_t));
+	if (!tables) {
+		return -2;
+	}
+	int err = 0;
+	for (int k = 0; k < num_threads*num_parts; k++) {
+		err |= histogram_hash_create(&tables[k], 1024);
+	}
+
+	if (err == 0) {
+		#pragma omp parallel num_threads(num_threads)
+		{
+			size_t begin, end;
+			int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+			histogram_hash_t *own = &tables[tid*num_parts];
+
+			for (size_t i = begin; i < end; i++) {
+				unsigned int g = Groups[i];
+				if (g < (unsigned int)num_groups) {
+					int part = (int)((uint64_t)g*num_parts/num_groups);
+					if (histogram_hash_add(&own[part], (uint64_t)g*BIN_SIZE + (unsigned int)Data[i], 1) != 0) {
+						#pragma omp atomic
+						err |= 1;
+						break;
+					}
+				}
+			}
+
+			#pragma omp barrier
+
+			// after the barrier err is final; a failed count leaves Matrix untouched
+			if (err == 0) {
+				// thread p owns the rows of group range p and merges it from every thread
+				for (int p = tid; p < num_parts; p += num_threads) {
+					size_t g0 = ((size_t)num_groups*p + num_parts - 1)/num_parts;
+					size_t g1 = ((size_t)num_groups*(p+1) + num_parts - 1)/num_parts;
+					memset(&Matrix[g0*BIN_SIZE], 0, sizeof(BIN_DATA_TYPE)*(g1 - g0)*BIN_SIZE);
+					for (int t = 0; t < num_threads; t++) {
+						const histogram_hash_t *table = &tables[t*num_parts + p];
+						for (size_t s = 0; s <= table->mask; s++) {
+							if (table->slots[s].count) {
+								Matrix[table->slots[s].key] += (BIN_DATA_TYPE)table->slots[s].count;
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	for (int k = 0; k < num_threads*num_parts; k++) {
+		histogram_hash_release(&tables[k]);
+	}
+	free(tables);
+	return err ? -2 : 0;
+}
+
+
+int histogram_grouped(const INPUT_DATA_TYPE *Data, const unsigned int *Groups, size_t data_size,
+                      int num_groups, BIN_DATA_TYPE *Matrix) {
+
+	if ((size_t)num_groups*BIN_SIZE*sizeof(unsigned int) <= GROUPED_DENSE_BYTES) {
+		return grouped_dense(Data, Groups, data_size, num_groups, Matrix);
+	}
+	return grouped_sparse(Data, Groups, data_size, num_groups, Matrix);
+}
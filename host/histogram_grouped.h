@@ -0,0 +1,47 @@
+/* File: histogram_grouped.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_grouped.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_GROUPED_h__
+#define __HISTOGRAM_GROUPED_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Largest per-thread dense partial, in bytes, before switching to sparse partials.
+#define GROUPED_DENSE_BYTES (1 << 20)
+
+// One histogram per group in a single pass: Matrix[g*BIN_SIZE + v] counts the
+// elements with Groups[i] == g and Data[i] == v. Matrix (num_groups x
+// BIN_SIZE) is overwritten; elements with a group id >= num_groups are ignored.
+//
+// Each thread counts into a private dense [groups x bins] partial while that
+// fits GROUPED_DENSE_BYTES. Beyond that it spills to hash tables, one per
+// group range, so that each merging thread owns a disjoint set of rows.
+// Returns 0 on success, -2 if allocation fails.
+int histogram_grouped(const INPUT_DATA_TYPE *Data, const unsigned int *Groups, size_t data_size,
+                      int num_groups, BIN_DATA_TYPE *Matrix);
+
+#endif // __HISTOGRAM_GROUPED_h__
@@ -0,0 +1,102 @@
+/* File: histogram_hash.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_hash.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+int histogram_hash_create(histogram_hash_t *table, size_t capacity) {
+	size_t c = 16;
+	while (c < capacity) {
+		c *= 2;
+	}
+	table->slots = (histogram_hash_entry_t *)calloc(c, sizeof(histogram_hash_entry_t));
+	table->mask  = c - 1;
+	table->size  = 0;
+	return table->slots ? 0 : -2;
+}
+
+
+void histogram_hash_release(histogram_hash_t *table) {
+	free(table->slots);
+	table->slots = NULL;
+	table->size  = 0;
+}
+
+
+void histogram_hash_clear(histogram_hash_t *table) {
+	memset(table->slots, 0, sizeof(histogram_hash_entry_t)*(table->mask + 1));
+	table->size = 0;
+}
+
+
+int histogram_hash_grow(histogram_hash_t *table) {
+	histogram_hash_t bigger;
+	if (histogram_hash_create(&bigger, 2*(table->mask + 1)) != 0) {
+		return -2;
+	}
+	for (size_t i = 0; i <= table->mask; i++) {
+		const histogram_hash_entry_t *e = &table->slots[i];
+		if (e->count) {
+			size_t j = (size_t)histogram_hash_mix(e->key) & bigger.mask;
+			while (bigger.slots[j].count) {
+				j = (j + 1) & bigger.mask;
+			}
+			bigger.slots[j] = *e;
+		}
+	}
+	bigger.size = table->size;
+	free(table->slots);
+	*table = bigger;
+	return 0;
+}
+
+
+void histogram_hash_remove(histogram_hash_t *table, uint64_t key) {
+	histogram_hash_entry_t *e = histogram_hash_slot(table, key);
+	if (e->count == 0) {
+		return;
+	}
+	size_t hole = (size_t)(e - table->slots);
+	size_t i = hole;
+	for (;;) {
+		i = (i + 1) & table->mask;
+		histogram_hash_entry_t *next = &table->slots[i];
+		if (next->count == 0) {
+			break;
+		}
+		// move next into the hole unless its home slot lies cyclically in (hole, i]
+		size_t home = (size_t)histogram_hash_mix(next->key) & table->mask;
+		if (((i - home) & table->mask) >= ((i - hole) & table->mask)) {
+			table->slots[hole] = *next;
+			hole = i;
+		}
+	}
+	table->slots[hole].key   = 0;
+	table->slots[hole].count = 0;
+	table->size--;
+}
@@ -0,0 +1,133 @@
+/* File: histogram_hash.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_hash.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_HASH_h__
+#define __HISTOGRAM_HASH_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Open-addressing (linear probing) table of 64-bit key -> count, the sparse
+// counterpart of a histogram bin array. Key and count share a 16-byte slot
+// so a probe touches one cache line; a zero count marks an empty slot.
+// The table doubles when it is half full.
+typedef struct {
+	uint64_t key;
+	uint64_t count;
+} histogram_hash_entry_t;
+
+typedef struct {
+	histogram_hash_entry_t *slots;
+	size_t                  mask;      // capacity - 1, capacity a power of two
+	size_t                  size;
+} histogram_hash_t;
+
+// capacity is rounded up to a power of two. Returns 0, or -2 if allocation fails.
+int histogram_hash_create(histogram_hash_t *table, size_t capacity);
+void histogram_hash_release(histogram_hash_t *table);
+void histogram_hash_clear(histogram_hash_t *table);
+// Doubles the capacity. Returns 0, or -2 if allocation fails.
+int histogram_hash_grow(histogram_hash_t *table);
+// Removes key if present. Later entries of its probe run are shifted back,
+// so slot pointers obtained before the call are invalidated.
+void histogram_hash_remove(histogram_hash_t *table, uint64_t key);
+
+// 64-bit mixer (MurmurHash3 finaliser).
+static inline uint64_t histogram_hash_mix(uint64_t key) {
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return key;
+}
+
+// Slot holding key, or the empty slot where it would be inserted. A caller
+// filling an empty slot also increments table->size; it must keep the table
+// at most half full itself, since this does not grow it.
+static inline histogram_hash_entry_t *histogram_hash_slot(histogram_hash_t *table, uint64_t key) {
+	size_t i = (size_t)histogram_hash_mix(key) & table->mask;
+	for (;;) {
+		histogram_hash_entry_t *e = &table->slots[i];
+		if (e->count == 0 || e->key == key) {
+			return e;
+		}
+		i = (i + 1) & table->mask;
+	}
+}
+
+// Adds count to key; hash must be histogram_hash_mix(key), for callers
+// that also use the hash bits to pick a partition. Returns 0, or -2 if a
+// new key cannot be inserted because the table could not grow and has no
+// empty slot to spare (one always stays empty so probes terminate); the
+// table is unchanged then.
+static inline int histogram_hash_add_hashed(histogram_hash_t *table, uint64_t key, uint64_t hash, uint64_t count) {
+	if (count == 0) {
+		return 0;		// a zero count would look like an empty slot
+	}
+	size_t i = (size_t)hash & table->mask;
+	histogram_hash_entry_t *e;
+	for (;;) {
+		e = &table->slots[i];
+		if (e->count == 0) {
+			break;
+		}
+		if (e->key == key) {
+			e->count += count;
+			return 0;
+		}
+		i = (i + 1) & table->mask;
+	}
+	if ((table->size + 1)*2 > table->mask + 1) {
+		if (histogram_hash_grow(table) == 0) {
+			e = histogram_hash_slot(table, key);
+		} else if (table->size + 2 > table->mask + 1) {
+			return -2;
+		}
+	}
+	e->key   = key;
+	e->count = count;
+	table->size++;
+	return 0;
+}
+
+static inline int histogram_hash_add(histogram_hash_t *table, uint64_t key, uint64_t count) {
+	return histogram_hash_add_hashed(table, key, histogram_hash_mix(key), count);
+}
+
+// Count of key, 0 if absent.
+static inline uint64_t histogram_hash_find(const histogram_hash_t *table, uint64_t key) {
+	size_t i = (size_t)histogram_hash_mix(key) & table->mask;
+	for (;;) {
+		const histogram_hash_entry_t *e = &table->slots[i];
+		if (e->count == 0 || e->key == key) {
+			return e->count;
+		}
+		i = (i + 1) & table->mask;
+	}
+}
+
+#endif // __HISTOGRAM_HASH_h__
@@ -0,0 +1,258 @@
+/* File: histogram_hdr.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_hdr.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_hdr.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+int histogram_hdr_create(histogram_hdr_t *h, int64_t lowest, int64_t highest, int significant_digits) {
+
+	if (lowest < 1 || highest < 2*lowest || significant_digits < 1 || significant_digits > 5) {
+		return -1;
+	}
+
+	int64_t largest_single_unit = 2;
+	for (int d = 0; d < significant_digits; d++) {
+		largest_single_unit *= 10;
+	}
+	int sub_bucket_count_magnitude = 0;
+	while (((int64_t)1 << sub_bucket_count_magnitude) < largest_single_unit) {
+		sub_bucket_count_magnitude++;
+	}
+	int half_magnitude = (sub_bucket_count_magnitude > 1 ? sub_bucket_count_magnitude : 1) - 1;
+	int unit_magnitude = 63 - __builtin_clzll((uint64_t)lowest);
+	int64_t sub_bucket_count = (int64_t)1 << (half_magnitude + 1);
+
+	// buckets needed to cover highest, each doubling the range
+	int64_t smallest_untrackable = sub_bucket_count << unit_magnitude;
+	int bucket_count = 1;
+	while (smallest_untrackable <= highest) {
+		if (smallest_untrackable > INT64_MAX/2) {
+			bucket_count++;
+			break;
+		}
+		smallest_untrackable <<= 1;
+		bucket_count++;
+	}
+
+	h->lowest             = lowest;
+	h->highest            = highest;
+	h->significant_digits = significant_digits;
+	h->unit_magnitude     = unit_magnitude;
+	h->sub_bucket_half_count_magnitude = half_magnitude;
+	h->sub_bucket_half_count = (int)(sub_bucket_count/2);
+	h->sub_bucket_mask    = (sub_bucket_count - 1) << unit_magnitude;
+	h->bucket_count       = bucket_count;
+	h->counts_len         = (bucket_count + 1)*(int)(sub_bucket_count/2);
+	h->total              = 0;
+	h->counts             = (uint64_t *)calloc(h->counts_len, sizeof(uint64_t));
+	return h->counts ? 0 : -2;
+}
+
+
+void histogram_hdr_release(histogram_hdr_t *h) {
+	free(h->counts);
+	h->counts = NULL;
+}
+
+
+void histogram_hdr_reset(histogram_hdr_t *h) {
+	memset(h->counts, 0, sizeof(uint64_t)*h->counts_len);
+	h->total = 0;
+}
+
+
+size_t histogram_hdr_record_values(histogram_hdr_t *h, const int64_t *values, size_t num_values) {
+	// layout copied to locals: the counter stores may alias the struct fields
+	uint64_t *counts    = h->counts;
+	uint64_t  highest   = (uint64_t)h->highest;
+	uint64_t  mask      = (uint64_t)h->sub_bucket_mask;
+	int       shift     = h->unit_magnitude + h->sub_bucket_half_count_magnitude + 1;
+	int       half_mag  = h->sub_bucket_half_count_magnitude;
+	int       base      = h->unit_magnitude;
+	int64_t   half      = h->sub_bucket_half_count;
+	size_t    rejected  = 0;
+
+	for (size_t i = 0; i < num_values; i++) {
+		uint64_t v = (uint64_t)values[i];
+		if (v > highest) {	// negative values wrap above highest
+			rejected++;
+			continue;
+		}
+		int bucket_index = 64 - __builtin_clzll(v | mask) - shift;
+		int64_t sub_bucket_index = (int64_t)(v >> (bucket_index + base));
+		counts[((int64_t)(bucket_index + 1) << half_mag) + sub_bucket_index - half]++;
+	}
+	h->total += num_values - rejected;
+	return rejected;
+}
+
+
+int histogram_hdr_add(histogram_hdr_t *dst, const histogram_hdr_t *src) {
+	if (dst->lowest != src->lowest || dst->counts_len != src->counts_len ||
+	    dst->significant_digits != src->significant_digits) {
+		return -1;
+	}
+	for (int i = 0; i < dst->counts_len; i++) {
+		dst->counts[i] += src->counts[i];
+	}
+	dst->total += src->total;
+	return 0;
+}
+
+
+// Lowest value and width of the range of values sharing counts[index].
+static void hdr_index_range(const histogram_hdr_t *h, int index, int64_t *low, int64_t *width) {
+	int bucket_index = (index >> h->sub_bucket_half_count_magnitude) - 1;
+	int sub_bucket_index = (index & (h->sub_bucket_half_count - 1)) + h->sub_bucket_half_count;
+	if (bucket_index < 0) {
+		sub_bucket_index -= h->sub_bucket_half_count;
+		bucket_index = 0;
+	}
+	*low   = (int64_t)sub_bucket_index << (bucket_index + h->unit_magnitude);
+	*width = (int64_t)1 << (bucket_index + h->unit_magnitude);
+}
+
+
+int64_t histogram_hdr_percentile(const histogram_hdr_t *h, double percentile) {
+	if (h->total == 0) {
+		return 0;
+	}
+	// clamp to [0, 100] before the conversion; NaN counts as 0
+	if (!(percentile >= 0.0)) {
+		percentile = 0.0;
+	}
+	if (percentile > 100.0) {
+		percentile = 100.0;
+	}
+	uint64_t target = (uint64_t)ceil(percentile/100.0*(double)h->total);
+	if (target < 1) {
+		target = 1;
+	}
+	uint64_t running = 0;
+	for (int i = 0; i < h->counts_len; i++) {
+		running += h->counts[i];
+		if (running >= target) {
+			int64_t low, width;
+			hdr_index_range(h, i, &low, &width);
+			return low + width - 1;
+		}
+	}
+	return 0;
+}
+
+
+int64_t histogram_hdr_min(const histogram_hdr_t *h) {
+	for (int i = 0; i < h->counts_len; i++) {
+		if (h->counts[i]) {
+			int64_t low, width;
+			hdr_index_range(h, i, &low, &width);
+			return low;
+		}
+	}
+	return 0;
+}
+
+
+int64_t histogram_hdr_max(const histogram_hdr_t *h) {
+	for (int i = h->counts_len - 1; i >= 0; i--) {
+		if (h->counts[i]) {
+			int64_t low, width;
+			hdr_index_range(h, i, &low, &width);
+			return low + width - 1;
+		}
+	}
+	return 0;
+}
+
+
+double histogram_hdr_mean(const histogram_hdr_t *h) {
+	if (h->total == 0) {
+		return 0.0;
+	}
+	double sum = 0;
+	for (int i = 0; i < h->counts_len; i++) {
+		if (h->counts[i]) {
+			int64_t low, width;
+			hdr_index_range(h, i, &low, &width);
+			sum += (double)h->counts[i]*((double)low + (double)(width/2));
+		}
+	}
+	return sum/(double)h->total;
+}
+
+
+int histogram_hdr_recorder_create(histogram_hdr_recorder_t *r, int num_shards, int64_t lowest, int64_t highest, int significant_digits) {
+	r->num_shards = num_shards;
+	r->shards = (histogram_hdr_t *)calloc(num_shards, sizeof(histogram_hdr_t));
+	if (!r->shards) {
+		return -2;
+	}
+	for (int s = 0; s < num_shards; s++) {
+		int err = histogram_hdr_create(&r->shards[s], lowest, highest, significant_digits);
+		if (err) {
+			histogram_hdr_recorder_release(r);
+			return err;
+		}
+	}
+	return 0;
+}
+
+
+void histogram_hdr_recorder_release(histogram_hdr_recorder_t *r) {
+	for (int s = 0; r->shards && s < r->num_shards; s++) {
+		histogram_hdr_release(&r->shards[s]);
+	}
+	free(r->shards);
+	r->shards = NULL;
+}
+
+
+size_t histogram_hdr_recorder_record(histogram_hdr_recorder_t *r, const int64_t *values, size_t num_values) {
+	size_t rejected = 0;
+
+	#pragma omp parallel num_threads(r->num_shards) reduction(+:rejected)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(num_values, &begin, &end);
+		rejected += histogram_hdr_record_values(&r->shards[tid], &values[begin], end - begin);
+	}
+	return rejected;
+}
+
+
+int histogram_hdr_recorder_snapshot(const histogram_hdr_recorder_t *r, histogram_hdr_t *snapshot) {
+	histogram_hdr_reset(snapshot);
+	for (int s = 0; s < r->num_shards; s++) {
+		if (histogram_hdr_add(snapshot, &r->shards[s]) != 0) {
+			return -1;
+		}
+	}
+	return 0;
+}
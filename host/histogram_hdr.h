@@ -0,0 +1,106 @@
+/* File: histogram_hdr.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_hdr.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_HDR_h__
+#define __HISTOGRAM_HDR_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Log-bucketed (HDR) histogram for values spanning many orders of magnitude,
+// e.g. latencies in ns or object sizes in bytes.
+//
+// Values in [lowest, highest] are recorded with `significant_digits` decimal
+// digits of precision: bucket b holds sub_bucket_count/2 linear sub-buckets of
+// width 2^(unit_magnitude + b). The bucket of a value comes from its leading
+// zero count, so recording is a clz, two shifts and one increment.
+typedef struct {
+	int64_t   lowest;
+	int64_t   highest;
+	int       significant_digits;
+	int       unit_magnitude;
+	int       sub_bucket_half_count_magnitude;
+	int       sub_bucket_half_count;
+	int64_t   sub_bucket_mask;
+	int       bucket_count;
+	int       counts_len;
+	uint64_t  total;
+	uint64_t *counts;
+} histogram_hdr_t;
+
+// lowest >= 1, highest >= 2*lowest, 1 <= significant_digits <= 5.
+// Returns 0 on success, -1 for invalid arguments, -2 if allocation fails.
+int histogram_hdr_create(histogram_hdr_t *h, int64_t lowest, int64_t highest, int significant_digits);
+void histogram_hdr_release(histogram_hdr_t *h);
+void histogram_hdr_reset(histogram_hdr_t *h);
+
+static inline int histogram_hdr_index(const histogram_hdr_t *h, int64_t value) {
+	int pow2ceiling = 64 - __builtin_clzll((uint64_t)(value | h->sub_bucket_mask));
+	int bucket_index = pow2ceiling - h->unit_magnitude - (h->sub_bucket_half_count_magnitude + 1);
+	int sub_bucket_index = (int)(value >> (bucket_index + h->unit_magnitude));
+	return ((bucket_index + 1) << h->sub_bucket_half_count_magnitude) + (sub_bucket_index - h->sub_bucket_half_count);
+}
+
+// Records one value; returns 0, or -1 if it is outside [0, highest].
+static inline int histogram_hdr_record(histogram_hdr_t *h, int64_t value) {
+	if (value < 0 || value > h->highest) {
+		return -1;
+	}
+	h->counts[histogram_hdr_index(h, value)]++;
+	h->total++;
+	return 0;
+}
+
+// Records a batch; returns the number of values out of range (not recorded).
+size_t histogram_hdr_record_values(histogram_hdr_t *h, const int64_t *values, size_t num_values);
+
+// dst += src; both need the same lowest, highest and significant digits.
+// Returns 0, or -1 if the layouts differ.
+int histogram_hdr_add(histogram_hdr_t *dst, const histogram_hdr_t *src);
+
+// Value at the given percentile (0..100): the highest value equivalent to the
+// bucket that reaches it. O(buckets). 0 if the histogram is empty.
+int64_t histogram_hdr_percentile(const histogram_hdr_t *h, double percentile);
+int64_t histogram_hdr_min(const histogram_hdr_t *h);
+int64_t histogram_hdr_max(const histogram_hdr_t *h);
+double  histogram_hdr_mean(const histogram_hdr_t *h);
+
+
+// Per-thread shards: each thread records into its own histogram without
+// atomics or locks; the shards are summed when a snapshot is taken.
+typedef struct {
+	int              num_shards;
+	histogram_hdr_t *shards;
+} histogram_hdr_recorder_t;
+
+int histogram_hdr_recorder_create(histogram_hdr_recorder_t *r, int num_shards, int64_t lowest, int64_t highest, int significant_digits);
+void histogram_hdr_recorder_release(histogram_hdr_recorder_t *r);
+// Records values in parallel, thread t into shard t (num_shards >= threads).
+size_t histogram_hdr_recorder_record(histogram_hdr_recorder_t *r, const int64_t *values, size_t num_values);
+// Sums all shards into snapshot (created with the same layout).
+int histogram_hdr_recorder_snapshot(const histogram_hdr_recorder_t *r, histogram_hdr_t *snapshot);
+
+#endif // __HISTOGRAM_HDR_h__
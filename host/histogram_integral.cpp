@@ -0,0 +1,169 @@
+/* File: histogram_integral.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_integral.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_integral.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+// Single pass over the index: I(y+1, x+1) = I(y, x+1) + rowprefix(y, x).
+// Tile (ti, tj) needs the tile above (column sums) and the tile on its left
+// (row prefix carried in carry[y]), so tiles on one anti-diagonal are
+// independent and processed in parallel.
+template <typename T>
+static void integral_build(T *table, size_t row_stride, const unsigned char *Image, int width, int height, int pitch,
+                           int bins, int shift, T *carry) {
+
+	int tile_rows = (height + INTEGRAL_TILE_ROWS - 1)/INTEGRAL_TILE_ROWS;
+	int tile_cols = (width  + INTEGRAL_TILE_COLS - 1)/INTEGRAL_TILE_COLS;
+
+	#pragma omp parallel
+	{
+		for (int d = 0; d < tile_rows + tile_cols - 1; d++) {
+			int ti_begin = (d - tile_cols + 1 > 0) ? d - tile_cols + 1 : 0;
+			int ti_end   = (d < tile_rows - 1) ? d : tile_rows - 1;
+
+			#pragma omp for schedule(dynamic, 1)
+			for (int ti = ti_begin; ti <= ti_end; ti++) {
+				int tj = d - ti;
+				int y_end = (ti+1)*INTEGRAL_TILE_ROWS < height ? (ti+1)*INTEGRAL_TILE_ROWS : height;
+				int x_end = (tj+1)*INTEGRAL_TILE_COLS < width  ? (tj+1)*INTEGRAL_TILE_COLS : width;
+
+				for (int y = ti*INTEGRAL_TILE_ROWS; y < y_end; y++) {
+					T *running = carry + (size_t)y*bins;
+					const unsigned char *row = Image + (size_t)y*pitch;
+					const T *above = table + (size_t)y*row_stride;
+					T *out = table + (size_t)(y+1)*row_stride;
+
+					for (int x = tj*INTEGRAL_TILE_COLS; x < x_end; x++) {
+						running[row[x] >> shift]++;
+						const T *a = above + (size_t)(x+1)*bins;
+						T *o = out + (size_t)(x+1)*bins;
+						for (int b = 0; b < bins; b++) {
+							o[b] = (T)(a[b] + running[b]);
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+
+int histogram_integral_create(histogram_integral_t *ih, const unsigned char *Image, int width, int height, int pitch,
+                              int bins, int counter_bits) {
+
+	int shift = 0;
+	while ((BIN_SIZE >> shift) > bins) {
+		shift++;
+	}
+	if (width <= 0 || height <= 0 || pitch < width || bins < 1 || (BIN_SIZE >> shift) != bins ||
+	    (counter_bits != 16 && counter_bits != 32)) {
+		return -1;
+	}
+
+	size_t counter_size = counter_bits/8;
+	size_t row_stride = (size_t)(width+1)*bins;
+	void *table = calloc(row_stride*(height+1), counter_size);
+	void *carry = calloc((size_t)height*bins, counter_size);
+	if (!table || !carry) {
+		free(table);
+		free(carry);
+		return -2;
+	}
+
+	if (counter_bits == 16) {
+		integral_build((unsigned short *)table, row_stride, Image, width, height, pitch, bins, shift, (unsigned short *)carry);
+	} else {
+		integral_build((unsigned int *)table, row_stride, Image, width, height, pitch, bins, shift, (unsigned int *)carry);
+	}
+	free(carry);
+
+	ih->width        = width;
+	ih->height       = height;
+	ih->bins         = bins;
+	ih->shift        = shift;
+	ih->counter_bits = counter_bits;
+	ih->row_stride   = row_stride;
+	ih->table        = table;
+	return 0;
+}
+
+
+void histogram_integral_release(histogram_integral_t *ih) {
+	free(ih->table);
+	ih->table = NULL;
+}
+
+
+int histogram_integral_query(const histogram_integral_t *ih, int x0, int y0, int x1, int y1, BIN_DATA_TYPE *Histogram) {
+
+	if (x0 < 0 || y0 < 0 || x1 > ih->width || y1 > ih->height || x0 > x1 || y0 > y1) {
+		return -1;
+	}
+	if (ih->counter_bits == 16 && (long)(x1 - x0)*(y1 - y0) >= 65536) {
+		return -1;
+	}
+
+	size_t a = (size_t)y0*ih->row_stride + (size_t)x0*ih->bins;
+	size_t b = (size_t)y0*ih->row_stride + (size_t)x1*ih->bins;
+	size_t c = (size_t)y1*ih->row_stride + (size_t)x0*ih->bins;
+	size_t d = (size_t)y1*ih->row_stride + (size_t)x1*ih->bins;
+	int bins = ih->bins;
+	int j = 0;
+
+	if (ih->counter_bits == 16) {
+		const unsigned short *t = (const unsigned short *)ih->table;
+#ifdef __SSE2__
+		const __m128i zero = _mm_setzero_si128();
+		for (; j + 8 <= bins; j += 8) {
+			__m128i r = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)&t[d+j]), _mm_loadu_si128((const __m128i *)&t[b+j]));
+			r = _mm_add_epi16(_mm_sub_epi16(r, _mm_loadu_si128((const __m128i *)&t[c+j])), _mm_loadu_si128((const __m128i *)&t[a+j]));
+			_mm_storeu_si128((__m128i *)&Histogram[j],   _mm_unpacklo_epi16(r, zero));
+			_mm_storeu_si128((__m128i *)&Histogram[j+4], _mm_unpackhi_epi16(r, zero));
+		}
+#endif
+		for (; j < bins; j++) {
+			Histogram[j] = (unsigned short)(t[d+j] - t[b+j] - t[c+j] + t[a+j]);
+		}
+	} else {
+		const unsigned int *t = (const unsigned int *)ih->table;
+#ifdef __SSE2__
+		for (; j + 4 <= bins; j += 4) {
+			__m128i r = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)&t[d+j]), _mm_loadu_si128((const __m128i *)&t[b+j]));
+			r = _mm_add_epi32(_mm_sub_epi32(r, _mm_loadu_si128((const __m128i *)&t[c+j])), _mm_loadu_si128((const __m128i *)&t[a+j]));
+			_mm_storeu_si128((__m128i *)&Histogram[j], r);
+		}
+#endif
+		for (; j < bins; j++) {
+			Histogram[j] = (BIN_DATA_TYPE)(t[d+j] - t[b+j] - t[c+j] + t[a+j]);
+		}
+	}
+	return 0;
+}
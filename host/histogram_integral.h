@@ -0,0 +1,67 @@
+/* File: histogram_integral.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_integral.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_INTEGRAL_h__
+#define __HISTOGRAM_INTEGRAL_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Tile of the wavefront used to build the index (rows x columns).
+#define INTEGRAL_TILE_ROWS 64
+#define INTEGRAL_TILE_COLS 64
+
+// Integral histogram of an unsigned char image: entry (y, x) holds the
+// histogram of the rectangle [0, x) x [0, y), so the histogram of any
+// rectangle is D - B - C + A over its four corners, in O(bins).
+//
+// Memory is (width+1)*(height+1)*bins counters. It is kept in check by
+// quantising to bins = BIN_SIZE >> shift levels and by 16-bit counters:
+// these wrap, but the corner arithmetic is modulo 2^16 as well, so the
+// result is exact for rectangles of fewer than 65536 pixels.
+typedef struct {
+	int    width;
+	int    height;
+	int    bins;
+	int    shift;
+	int    counter_bits;      // 16 or 32
+	size_t row_stride;        // counters per index row, (width+1)*bins
+	void  *table;
+} histogram_integral_t;
+
+// Builds the index in one wavefront pass over tiles. bins must be a power of
+// two <= BIN_SIZE. Returns 0 on success, -1 for invalid arguments, -2 if
+// allocation fails.
+int histogram_integral_create(histogram_integral_t *ih, const unsigned char *Image, int width, int height, int pitch,
+                              int bins, int counter_bits);
+void histogram_integral_release(histogram_integral_t *ih);
+
+// Histogram (ih->bins entries) of the rectangle [x0, x1) x [y0, y1).
+// Returns 0 on success, -1 if the rectangle is invalid or too large for
+// 16-bit counters.
+int histogram_integral_query(const histogram_integral_t *ih, int x0, int y0, int x1, int y1, BIN_DATA_TYPE *Histogram);
+
+#endif // __HISTOGRAM_INTEGRAL_h__
@@ -0,0 +1,248 @@
+/* File: histogram_joint.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_joint.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_joint.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+// Rows of the joint histogram merged together by one thread.
+#define JOINT_MERGE_ROWS 8
+
+
+static int joint_log2(int bins, int max_bins) {
+	int l = 0;
+	while ((1 << l) < bins) {
+		l++;
+	}
+	return (bins >= 2 && bins <= max_bins && (1 << l) == bins) ? l : -1;
+}
+
+
+// Entropy of counts c_i with total N: H = log2(N) - sum(c_i*log2(c_i))/N.
+static inline void entropy_accumulate(double c, double *sum_clogc) {
+	if (c > 0) {
+		*sum_clogc += c*log2(c);
+	}
+}
+
+static inline double entropy_finish(double sum_clogc, double total) {
+	return (total > 0) ? log2(total) - sum_clogc/total : 0.0;
+}
+
+
+// Reduces the per-thread partials. Writes Joint if not NULL, and the
+// entropies if info is not NULL, merging JOINT_MERGE_ROWS rows of all
+// partials at a time. Returns 0, or -2 if allocation fails.
+static int joint_reduce(const unsigned int *partial, int num_partials, int log2_bins, BIN_DATA_TYPE *Joint, histogram_joint_info_t *info) {
+
+	int bins = 1 << log2_bins;
+	size_t cells = (size_t)bins*bins;
+	double s_a = 0, s_ab = 0, total = 0;
+	int failed = 0;
+	double *col = (double *)calloc(bins, sizeof(double));
+	if (!col) {
+		return -2;
+	}
+
+	#pragma omp parallel reduction(+:s_a,s_ab,total,failed)
+	{
+		unsigned int *row = (unsigned int *)malloc(sizeof(unsigned int)*bins*JOINT_MERGE_ROWS);
+		double *col_local = (double *)calloc(bins, sizeof(double));
+		if (!row || !col_local) {
+			failed = 1;
+		}
+
+		// every thread has to reach the worksharing loop
+		#pragma omp for schedule(static)
+		for (int r0 = 0; r0 < bins; r0 += JOINT_MERGE_ROWS) {
+			if (failed) {
+				continue;
+			}
+			int nrows = (r0 + JOINT_MERGE_ROWS <= bins) ? JOINT_MERGE_ROWS : bins - r0;
+			size_t base = (size_t)r0*bins;
+			size_t len  = (size_t)nrows*bins;
+
+			memcpy(row, &partial[base], sizeof(unsigned int)*len);
+			for (int t = 1; t < num_partials; t++) {
+				const unsigned int *p = &partial[t*cells + base];
+				for (size_t j = 0; j < len; j++) {
+					row[j] += p[j];
+				}
+			}
+
+			if (Joint) {
+				for (size_t j = 0; j < len; j++) {
+					Joint[base + j] = row[j];
+				}
+			}
+			if (info) {
+				for (int r = 0; r < nrows; r++) {
+					double row_sum = 0;
+					for (int b = 0; b < bins; b++) {
+						double c = row[r*bins + b];
+						row_sum += c;
+						col_local[b] += c;
+						entropy_accumulate(c, &s_ab);
+					}
+					entropy_accumulate(row_sum, &s_a);
+					total += row_sum;
+				}
+			}
+		}
+
+		if (info && !failed) {
+			#pragma omp critical
+			for (int b = 0; b < bins; b++) {
+				col[b] += col_local[b];
+			}
+		}
+		free(col_local);
+		free(row);
+	}
+
+	if (failed) {
+		free(col);
+		return -2;
+	}
+	if (info) {
+		double s_b = 0;
+		for (int b = 0; b < bins; b++) {
+			entropy_accumulate(col[b], &s_b);
+		}
+		info->entropy_a  = entropy_finish(s_a, total);
+		info->entropy_b  = entropy_finish(s_b, total);
+		info->entropy_ab = entropy_finish(s_ab, total);
+		info->mutual_information = info->entropy_a + info->entropy_b - info->entropy_ab;
+	}
+	free(col);
+	return 0;
+}
+
+
+template <typename T>
+static int joint_histogram(const T *A, const T *B, size_t data_size, int bins, BIN_DATA_TYPE *Joint, histogram_joint_info_t *info) {
+
+	int max_bins = (sizeof(T) == 1) ? 256 : JOINT_MAX_BINS;
+	int log2_bins = joint_log2(bins, max_bins);
+	if (log2_bins < 0) {
+		return -1;
+	}
+	int shift = 8*(int)sizeof(T) - log2_bins;
+	size_t cells = (size_t)bins*bins;
+
+	// one full private bins x bins table per thread: 256 KB each at 256
+	// levels, 4 MB at JOINT_MAX_BINS. Not split into L2 sized row bands;
+	// rereading or scattering the input per band cost more than the cache
+	// misses it saves. One thread if the tables do not fit.
+	int num_threads = histogram_cpu_threads();
+	unsigned int *partial = (unsigned int *)calloc((size_t)num_threads*cells, sizeof(unsigned int));
+	if (!partial && num_threads > 1) {
+		num_threads = 1;
+		partial = (unsigned int *)calloc(cells, sizeof(unsigned int));
+	}
+	if (!partial) {
+		return -2;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+		unsigned int *h = partial + tid*cells;
+		size_t i = begin;
+
+		for (; i + 4 <= end; i += 4) {
+			unsigned int j0 = ((unsigned int)(A[i  ] >> shift) << log2_bins) | (unsigned int)(B[i  ] >> shift);
+			unsigned int j1 = ((unsigned int)(A[i+1] >> shift) << log2_bins) | (unsigned int)(B[i+1] >> shift);
+			unsigned int j2 = ((unsigned int)(A[i+2] >> shift) << log2_bins) | (unsigned int)(B[i+2] >> shift);
+			unsigned int j3 = ((unsigned int)(A[i+3] >> shift) << log2_bins) | (unsigned int)(B[i+3] >> shift);
+			h[j0]++;
+			h[j1]++;
+			h[j2]++;
+			h[j3]++;
+		}
+		for (; i < end; i++) {
+			h[((unsigned int)(A[i] >> shift) << log2_bins) | (unsigned int)(B[i] >> shift)]++;
+		}
+	}
+
+	int err = joint_reduce(partial, num_threads, log2_bins, Joint, info);
+	free(partial);
+	return err;
+}
+
+
+int histogram_joint_u8(const unsigned char *A, const unsigned char *B, size_t data_size, int bins, BIN_DATA_TYPE *Joint) {
+	return joint_histogram(A, B, data_size, bins, Joint, (histogram_joint_info_t *)NULL);
+}
+
+int histogram_joint_u16(const unsigned short *A, const unsigned short *B, size_t data_size, int bins, BIN_DATA_TYPE *Joint) {
+	return joint_histogram(A, B, data_size, bins, Joint, (histogram_joint_info_t *)NULL);
+}
+
+int histogram_joint_info_u8(const unsigned char *A, const unsigned char *B, size_t data_size, int bins, histogram_joint_info_t *info) {
+	return joint_histogram(A, B, data_size, bins, (BIN_DATA_TYPE *)NULL, info);
+}
+
+int histogram_joint_info_u16(const unsigned short *A, const unsigned short *B, size_t data_size, int bins, histogram_joint_info_t *info) {
+	return joint_histogram(A, B, data_size, bins, (BIN_DATA_TYPE *)NULL, info);
+}
+
+
+int histogram_joint_entropy(const BIN_DATA_TYPE *Joint, int bins, histogram_joint_info_t *info) {
+
+	double s_a = 0, s_b = 0, s_ab = 0, total = 0;
+	double *col = (double *)calloc(bins, sizeof(double));
+	if (!col) {
+		return -2;
+	}
+
+	for (int a = 0; a < bins; a++) {
+		double row_sum = 0;
+		for (int b = 0; b < bins; b++) {
+			double c = Joint[a*bins + b];
+			row_sum += c;
+			col[b]  += c;
+			entropy_accumulate(c, &s_ab);
+		}
+		entropy_accumulate(row_sum, &s_a);
+		total += row_sum;
+	}
+	for (int b = 0; b < bins; b++) {
+		entropy_accumulate(col[b], &s_b);
+	}
+	free(col);
+
+	info->entropy_a  = entropy_finish(s_a, total);
+	info->entropy_b  = entropy_finish(s_b, total);
+	info->entropy_ab = entropy_finish(s_ab, total);
+	info->mutual_information = info->entropy_a + info->entropy_b - info->entropy_ab;
+
+	return 0;
+}
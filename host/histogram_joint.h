@@ -0,0 +1,61 @@
+/* File: histogram_joint.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_joint.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_JOINT_h__
+#define __HISTOGRAM_JOINT_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Largest number of levels per axis accepted for 16-bit inputs.
+#define JOINT_MAX_BINS 1024
+
+// Entropies (in bits) returned by the fused reductions.
+typedef struct {
+	double entropy_a;
+	double entropy_b;
+	double entropy_ab;
+	double mutual_information;   // entropy_a + entropy_b - entropy_ab
+} histogram_joint_info_t;
+
+// Joint histogram of two equally sized images, each quantised to `bins`
+// levels (a power of two, at most 256 for 8-bit and JOINT_MAX_BINS for
+// 16-bit data). Joint[a*bins + b] counts the pairs (A[i], B[i]); it is
+// overwritten. Returns 0 on success, -1 for an invalid bin count, -2 if
+// allocation fails.
+int histogram_joint_u8(const unsigned char *A, const unsigned char *B, size_t data_size, int bins, BIN_DATA_TYPE *Joint);
+int histogram_joint_u16(const unsigned short *A, const unsigned short *B, size_t data_size, int bins, BIN_DATA_TYPE *Joint);
+
+// Fused variants: the per-thread partials are reduced straight into the
+// marginal and joint entropies, the joint histogram is never stored.
+int histogram_joint_info_u8(const unsigned char *A, const unsigned char *B, size_t data_size, int bins, histogram_joint_info_t *info);
+int histogram_joint_info_u16(const unsigned short *A, const unsigned short *B, size_t data_size, int bins, histogram_joint_info_t *info);
+
+// Entropies of an already computed joint histogram. Returns 0, or -2 if
+// allocation fails.
+int histogram_joint_entropy(const BIN_DATA_TYPE *Joint, int bins, histogram_joint_info_t *info);
+
+#endif // __HISTOGRAM_JOINT_h__
@@ -0,0 +1,115 @@
+/* File: histogram_multichannel.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_multichannel.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_multichannel.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+
+// Per-thread counters: [copy][channel][bin]. Pixel lane j of a group of four
+// goes to copy j, so equal neighbouring pixels hit different counters.
+#define MC_STRIDE (MULTICHANNEL_MAX_CHANNELS*BIN_SIZE)
+
+
+#ifdef __SSSE3__
+// Four planar 32-bit lanes (one byte per pixel) after the shuffle.
+static inline void mc_count_lanes(unsigned int *h, __m128i planar, int channels) {
+	uint64_t rg = (uint64_t)_mm_cvtsi128_si64(planar);
+	uint64_t ba = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(planar, planar));
+	uint64_t lanes[2] = { rg, ba };
+
+	for (int c = 0; c < channels; c++) {
+		unsigned int v = (unsigned int)(lanes[c >> 1] >> (32*(c & 1)));
+		unsigned int *hc = h + c*BIN_SIZE;
+		hc[0*MC_STRIDE + ( v        & 0xFF)]++;
+		hc[1*MC_STRIDE + ((v >>  8) & 0xFF)]++;
+		hc[2*MC_STRIDE + ((v >> 16) & 0xFF)]++;
+		hc[3*MC_STRIDE + ( v >> 24        )]++;
+	}
+}
+#endif
+
+
+int histogram_multichannel(const unsigned char *Pixels, size_t num_pixels, int channels, BIN_DATA_TYPE *Histograms) {
+
+	if (channels != 3 && channels != 4) {
+		return -1;
+	}
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int *partial = (unsigned int *)calloc((size_t)num_threads*HISTOGRAM_CPU_COPIES*MC_STRIDE, sizeof(unsigned int));
+	if (!partial) {
+		return -2;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(num_pixels, &begin, &end);
+		unsigned int *h = partial + (size_t)tid*HISTOGRAM_CPU_COPIES*MC_STRIDE;
+		size_t p = begin;
+
+#ifdef __SSSE3__
+		if (channels == 4) {
+			const __m128i deinterleave = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+			for (; p + 4 <= end; p += 4) {
+				__m128i v = _mm_loadu_si128((const __m128i *)&Pixels[4*p]);
+				mc_count_lanes(h, _mm_shuffle_epi8(v, deinterleave), 4);
+			}
+		} else {
+			// 12 bytes per group of four pixels, the 16-byte load needs two spare pixels
+			const __m128i deinterleave = _mm_setr_epi8(0, 3, 6, 9, 1, 4, 7, 10, 2, 5, 8, 11, -1, -1, -1, -1);
+			for (; p + 6 <= end; p += 4) {
+				__m128i v = _mm_loadu_si128((const __m128i *)&Pixels[3*p]);
+				mc_count_lanes(h, _mm_shuffle_epi8(v, deinterleave), 3);
+			}
+		}
+#endif
+		for (; p < end; p++) {
+			unsigned int *hp = h + (p & 3)*MC_STRIDE;
+			for (int c = 0; c < channels; c++) {
+				hp[c*BIN_SIZE + Pixels[channels*p + c]]++;
+			}
+		}
+	}
+
+	for (int j = 0; j < channels*BIN_SIZE; j++) {
+		Histograms[j] = 0;
+	}
+	for (int k = 0; k < num_threads*HISTOGRAM_CPU_COPIES; k++) {
+		const unsigned int *h = partial + (size_t)k*MC_STRIDE;
+		for (int j = 0; j < channels*BIN_SIZE; j++) {
+			Histograms[j] += h[j];
+		}
+	}
+
+	free(partial);
+	return 0;
+}
@@ -0,0 +1,42 @@
+/* File: histogram_multichannel.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_multichannel.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_MULTICHANNEL_h__
+#define __HISTOGRAM_MULTICHANNEL_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+#define MULTICHANNEL_MAX_CHANNELS 4
+
+// One-pass histograms of interleaved RGB (channels = 3) or RGBA (channels = 4)
+// pixels. Histograms is channels x BIN_SIZE, one histogram per channel
+// (Histograms[c*BIN_SIZE + v]); it is overwritten.
+// Returns 0 on success, -1 for an unsupported channel count, -2 if
+// allocation fails.
+int histogram_multichannel(const unsigned char *Pixels, size_t num_pixels, int channels, BIN_DATA_TYPE *Histograms);
+
+#endif // __HISTOGRAM_MULTICHANNEL_h__
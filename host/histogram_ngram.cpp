@@ -0,0 +1,196 @@
+/* File: histogram_ngram.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_ngram.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_ngram.h"
+#include "histogram_stream.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+size_t histogram_ngram_bins(int n, int bits) {
+	if (n == 2) {
+		return NGRAM_BIGRAM_BINS;
+	}
+	if (n == 3 && bits >= NGRAM_MIN_BITS && bits <= NGRAM_MAX_BITS) {
+		return (size_t)1 << bits;
+	}
+	return 0;
+}
+
+
+static inline uint64_t ngram_load_be(const unsigned char *p) {
+	uint64_t w;
+	memcpy(&w, p, sizeof(w));
+	return __builtin_bswap64(w);
+}
+
+
+// Counts the pairs starting at Data[0..count-1]; reads Data[count] too.
+static void ngram_count_pairs(const unsigned char *Data, size_t count, unsigned int *h) {
+	size_t i = 0;
+#ifdef __SSE2__
+	// interleaving the bytes at i+1 (low) with those at i (high) yields
+	// sixteen 16-bit pair indices per pair of overlapping loads
+	uint16_t idx[16];
+	for (; i + 17 <= count + 1; i += 16) {
+		__m128i a = _mm_loadu_si128((const __m128i *)&Data[i]);
+		__m128i b = _mm_loadu_si128((const __m128i *)&Data[i + 1]);
+		_mm_storeu_si128((__m128i *)&idx[0], _mm_unpacklo_epi8(b, a));
+		_mm_storeu_si128((__m128i *)&idx[8], _mm_unpackhi_epi8(b, a));
+		for (int j = 0; j < 16; j++) {
+			h[idx[j]]++;
+		}
+	}
+#else
+	// seven pairs per 64-bit load
+	for (; i + 8 <= count + 1; i += 7) {
+		uint64_t w = ngram_load_be(&Data[i]);
+		for (int j = 0; j < 7; j++) {
+			h[(w >> (48 - 8*j)) & 0xFFFF]++;
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		h[(Data[i] << 8) | Data[i + 1]]++;
+	}
+}
+
+
+static inline uint32_t ngram_hash(uint32_t key, int bits) {
+	return bits == 24 ? key : (key*0x9E3779B1u) >> (32 - bits);
+}
+
+
+// Counts the trigrams starting at Data[0..count-1]; reads Data[count+1] too.
+static void ngram_count_triples(const unsigned char *Data, size_t count, int bits, unsigned int *h) {
+	size_t i = 0;
+	// six trigrams per 64-bit load
+	for (; i + 8 <= count + 2; i += 6) {
+		uint64_t w = ngram_load_be(&Data[i]);
+		for (int j = 0; j < 6; j++) {
+			h[ngram_hash((uint32_t)(w >> (40 - 8*j)) & 0xFFFFFF, bits)]++;
+		}
+	}
+	for (; i < count; i++) {
+		h[ngram_hash(((uint32_t)Data[i] << 16) | (Data[i + 1] << 8) | Data[i + 2], bits)]++;
+	}
+}
+
+
+int histogram_ngram_accumulate(const unsigned char *Data, size_t data_size, int n, int bits, uint64_t *Hist) {
+	size_t bins = histogram_ngram_bins(n, bits);
+	if (bins == 0) {
+		return -1;
+	}
+	if (data_size < (size_t)n) {
+		return 0;
+	}
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int *partial = (unsigned int *)malloc(sizeof(unsigned int)*bins*num_threads);
+	if (!partial) {
+		return -2;
+	}
+
+	// one partial per thread (256 KB for bigrams, L2 resident); rounds keep
+	// the 32-bit partials from overflowing on very large inputs
+	size_t num_grams = data_size - n + 1;
+	for (size_t round = 0; round < num_grams; round += NGRAM_ROUND_SIZE) {
+		size_t round_grams = num_grams - round < NGRAM_ROUND_SIZE ? num_grams - round : NGRAM_ROUND_SIZE;
+
+		#pragma omp parallel num_threads(num_threads)
+		{
+			size_t begin, end;
+			int tid = histogram_cpu_thread_range(round_grams, &begin, &end);
+			unsigned int *h = &partial[(size_t)tid*bins];
+			memset(h, 0, sizeof(unsigned int)*bins);
+			if (n == 2) {
+				ngram_count_pairs(&Data[round + begin], end - begin, h);
+			} else {
+				ngram_count_triples(&Data[round + begin], end - begin, bits, h);
+			}
+
+			#pragma omp barrier
+			#pragma omp for schedule(static)
+			for (long long b = 0; b < (long long)bins; b++) {
+				uint64_t s = 0;
+				for (int t = 0; t < num_threads; t++) {
+					s += partial[(size_t)t*bins + b];
+				}
+				Hist[b] += s;
+			}
+		}
+	}
+
+	free(partial);
+	return 0;
+}
+
+
+int histogram_bigram(const INPUT_DATA_TYPE *Data, size_t data_size, BIN_DATA_TYPE *Bigram) {
+	uint64_t *hist = (uint64_t *)calloc(NGRAM_BIGRAM_BINS, sizeof(uint64_t));
+	if (!hist) {
+		return -2;
+	}
+	int err = histogram_ngram_accumulate((const unsigned char *)Data, data_size, 2, 0, hist);
+	for (int b = 0; b < NGRAM_BIGRAM_BINS; b++) {
+		Bigram[b] = (BIN_DATA_TYPE)hist[b];
+	}
+	free(hist);
+	return err;
+}
+
+
+typedef struct {
+	int       n;
+	int       bits;
+	uint64_t *hist;
+} ngram_stream_t;
+
+
+// Each chunk starts with the last n-1 bytes of the previous one, so an
+// n-gram across the boundary starts in the carried bytes and is counted here
+// only.
+static int ngram_chunk(const unsigned char *data, size_t size, uint64_t offset, void *ctx) {
+	ngram_stream_t *ns = (ngram_stream_t *)ctx;
+	(void)offset;
+	return histogram_ngram_accumulate(data, size, ns->n, ns->bits, ns->hist);
+}
+
+
+int histogram_ngram_file(const char *filename, int n, int bits, uint64_t *Hist) {
+	size_t bins = histogram_ngram_bins(n, bits);
+	if (bins == 0) {
+		return -1;
+	}
+	memset(Hist, 0, sizeof(uint64_t)*bins);
+	ngram_stream_t ns = { n, bits, Hist };
+	return histogram_stream_file(filename, STREAM_CHUNK_SIZE, (size_t)n - 1, ngram_chunk, &ns);
+}
@@ -0,0 +1,66 @@
+/* File: histogram_ngram.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_ngram.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_NGRAM_h__
+#define __HISTOGRAM_NGRAM_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Bins of the byte-pair histogram.
+#define NGRAM_BIGRAM_BINS 65536
+
+// Range of hash bits for trigrams; at 24 bits the trigram index is exact.
+#define NGRAM_MIN_BITS 8
+#define NGRAM_MAX_BITS 24
+
+// Bytes counted per round before the 32-bit per-thread partials are
+// flushed into the 64-bit result.
+#define NGRAM_ROUND_SIZE ((size_t)1 << 30)
+
+// Number of bins for an n-gram histogram: 65536 for n = 2, 2^bits for
+// n = 3, 0 if n or bits is invalid.
+size_t histogram_ngram_bins(int n, int bits);
+
+// Adds the n-grams that lie completely inside Data to Hist (bins() entries):
+// - n = 2: Hist[(Data[i] << 8) | Data[i+1]] for every i, bits is ignored.
+// - n = 3: the 24-bit key (Data[i] << 16) | (Data[i+1] << 8) | Data[i+2],
+//   hashed multiplicatively to `bits` bits (used as is when bits = 24).
+// Returns 0 on success, -1 for invalid n or bits, -2 if allocation fails.
+int histogram_ngram_accumulate(const unsigned char *Data, size_t data_size, int n, int bits, uint64_t *Hist);
+
+// Byte-pair histogram of a buffer, the 65536-bin counterpart of
+// histogram_cpu. Bigram is overwritten. Returns 0, or -2 if allocation fails.
+int histogram_bigram(const INPUT_DATA_TYPE *Data, size_t data_size, BIN_DATA_TYPE *Bigram);
+
+// n-gram histogram of a whole file, streamed in chunks; n-grams across chunk
+// boundaries are counted once. Hist is overwritten.
+// Returns 0, -1 for invalid arguments or a missing file, -2 on allocation or
+// read failure.
+int histogram_ngram_file(const char *filename, int n, int bits, uint64_t *Hist);
+
+#endif // __HISTOGRAM_NGRAM_h__
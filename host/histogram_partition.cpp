@@ -0,0 +1,167 @@
+/* File: histogram_partition.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_partition.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_partition.h"
+#include "histogram_scatter.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static inline uint64_t partition_key(uint64_t k)                 { return k; }
+static inline uint64_t partition_key(const histogram_tuple_t &t) { return t.key; }
+
+
+static inline size_t partition_chunk_begin(size_t n, int c, int num_chunks) {
+	return n*(size_t)c/(size_t)num_chunks;
+}
+
+
+template <typename T>
+static int partition_counts(const T *In, size_t n, int bits, int num_chunks, uint64_t *ChunkCounts) {
+	if (bits < 1 || bits > PARTITION_MAX_BITS || num_chunks < 1) {
+		return -1;
+	}
+	size_t P = (size_t)1 << bits;
+
+	#pragma omp parallel for schedule(static)
+	for (int c = 0; c < num_chunks; c++) {
+		uint64_t *h = &ChunkCounts[(size_t)c*P];
+		memset(h, 0, sizeof(uint64_t)*P);
+		size_t end = partition_chunk_begin(n, c + 1, num_chunks);
+		for (size_t i = partition_chunk_begin(n, c, num_chunks); i < end; i++) {
+			h[histogram_partition_of(partition_key(In[i]), bits)]++;
+		}
+	}
+	return 0;
+}
+
+
+template <typename T>
+static int partition_scatter(const T *In, size_t n, int bits, int num_chunks, const uint64_t *ChunkCounts, T *Out, size_t *Offsets) {
+	if (bits < 1 || bits > PARTITION_MAX_BITS || num_chunks < 1) {
+		return -1;
+	}
+	int P = 1 << bits;
+	size_t *pos = (size_t *)malloc(sizeof(size_t)*num_chunks*P);
+	if (!pos) {
+		return -2;
+	}
+
+	// partition-major prefix sum: chunk c's slice of partition p starts
+	// after the slices of the chunks before it
+	size_t running = 0;
+	for (int p = 0; p < P; p++) {
+		Offsets[p] = running;
+		for (int c = 0; c < num_chunks; c++) {
+			pos[(size_t)c*P + p] = running;
+			running += ChunkCounts[(size_t)c*P + p];
+		}
+	}
+	Offsets[P] = running;
+
+	#pragma omp parallel
+	{
+		// a thread without write-combining buffers scatters directly, so
+		// Out is always complete
+		histogram_scatter_t wc;
+		int use_wc = histogram_scatter_create(&wc, P) == 0;
+
+		#pragma omp for schedule(static)
+		for (int c = 0; c < num_chunks; c++) {
+			size_t *off = &pos[(size_t)c*P];
+			size_t begin = partition_chunk_begin(n, c, num_chunks);
+			size_t end = partition_chunk_begin(n, c + 1, num_chunks);
+			if (!use_wc) {
+				for (size_t i = begin; i < end; i++) {
+					Out[off[histogram_partition_of(partition_key(In[i]), bits)]++] = In[i];
+				}
+				continue;
+			}
+			histogram_scatter_begin(&wc, Out, off);
+			for (size_t i = begin; i < end; i++) {
+				histogram_scatter_push(&wc, Out, off, (int)histogram_partition_of(partition_key(In[i]), bits), In[i]);
+			}
+			histogram_scatter_flush(&wc, Out, off);
+		}
+
+		histogram_scatter_release(&wc);
+	}
+
+	free(pos);
+	return 0;
+}
+
+
+template <typename T>
+static int partition(const T *In, size_t n, int bits, T *Out, size_t *Offsets) {
+	if (bits < 1 || bits > PARTITION_MAX_BITS) {
+		return -1;
+	}
+	int num_chunks = histogram_cpu_threads();
+	uint64_t *counts = (uint64_t *)malloc(sizeof(uint64_t)*((size_t)num_chunks << bits));
+	if (!counts) {
+		return -2;
+	}
+	int err = partition_counts(In, n, bits, num_chunks, counts);
+	if (err == 0) {
+		err = partition_scatter(In, n, bits, num_chunks, counts, Out, Offsets);
+	}
+	free(counts);
+	return err;
+}
+
+
+int histogram_partition_u64(const uint64_t *Keys, size_t n, int bits, uint64_t *Out, size_t *Offsets) {
+	return partition(Keys, n, bits, Out, Offsets);
+}
+
+
+int histogram_partition_tuples(const histogram_tuple_t *In, size_t n, int bits, histogram_tuple_t *Out, size_t *Offsets) {
+	return partition(In, n, bits, Out, Offsets);
+}
+
+
+int histogram_partition_counts_u64(const uint64_t *Keys, size_t n, int bits, int num_chunks, uint64_t *ChunkCounts) {
+	return partition_counts(Keys, n, bits, num_chunks, ChunkCounts);
+}
+
+
+int histogram_partition_counts_tuples(const histogram_tuple_t *In, size_t n, int bits, int num_chunks, uint64_t *ChunkCounts) {
+	return partition_counts(In, n, bits, num_chunks, ChunkCounts);
+}
+
+
+int histogram_partition_scatter_u64(const uint64_t *Keys, size_t n, int bits, int num_chunks, const uint64_t *ChunkCounts,
+                                    uint64_t *Out, size_t *Offsets) {
+	return partition_scatter(Keys, n, bits, num_chunks, ChunkCounts, Out, Offsets);
+}
+
+
+int histogram_partition_scatter_tuples(const histogram_tuple_t *In, size_t n, int bits, int num_chunks, const uint64_t *ChunkCounts,
+                                       histogram_tuple_t *Out, size_t *Offsets) {
+	return partition_scatter(In, n, bits, num_chunks, ChunkCounts, Out, Offsets);
+}
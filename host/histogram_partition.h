@@ -0,0 +1,71 @@
+/* File: histogram_partition.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_partition.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_PARTITION_h__
+#define __HISTOGRAM_PARTITION_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Join/shuffle tuple: partitioned by key, payload carried along.
+typedef struct {
+	uint64_t key;
+	uint64_t payload;
+} histogram_tuple_t;
+
+// Partition of a key: the top `bits` bits of a multiplicative (Fibonacci)
+// hash. compute_partition_histogram_kernel uses the same function.
+static inline uint32_t histogram_partition_of(uint64_t key, int bits) {
+	return (uint32_t)((key*0x9E3779B97F4A7C15ull) >> (64 - bits));
+}
+
+// Hash partitioning in three phases: per-thread histograms, a global prefix
+// sum giving every thread its slice of every partition, and a scatter
+// through write-combining buffers. Partition p ends up in
+// Out[Offsets[p] .. Offsets[p+1]), with 2^bits + 1 Offsets; the order inside
+// a partition follows the input. 1 <= bits <= PARTITION_MAX_BITS (histogram.h):
+// at most 4096 write-combining lines per thread, 256 KB, still L2 resident.
+// Returns 0, -1 for invalid bits, -2 if allocation fails.
+int histogram_partition_u64(const uint64_t *Keys, size_t n, int bits, uint64_t *Out, size_t *Offsets);
+int histogram_partition_tuples(const histogram_tuple_t *In, size_t n, int bits, histogram_tuple_t *Out, size_t *Offsets);
+
+// Counting phase only. The input is cut into num_chunks equal chunks, chunk
+// c covering [n*c/num_chunks, n*(c+1)/num_chunks); ChunkCounts[c*2^bits + p]
+// receives the keys of chunk c in partition p.
+int histogram_partition_counts_u64(const uint64_t *Keys, size_t n, int bits, int num_chunks, uint64_t *ChunkCounts);
+int histogram_partition_counts_tuples(const histogram_tuple_t *In, size_t n, int bits, int num_chunks, uint64_t *ChunkCounts);
+
+// Prefix sum and scatter phases from chunk counts computed elsewhere, e.g.
+// by histogram_device_partition, so the CPU only scatters; the two phases
+// run one after the other. Chunks are scattered in parallel. Returns 0,
+// -1 for invalid bits, -2 if allocation fails, in which case Out is untouched.
+int histogram_partition_scatter_u64(const uint64_t *Keys, size_t n, int bits, int num_chunks, const uint64_t *ChunkCounts,
+                                    uint64_t *Out, size_t *Offsets);
+int histogram_partition_scatter_tuples(const histogram_tuple_t *In, size_t n, int bits, int num_chunks, const uint64_t *ChunkCounts,
+                                       histogram_tuple_t *Out, size_t *Offsets);
+
+#endif // __HISTOGRAM_PARTITION_h__
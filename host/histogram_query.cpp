@@ -0,0 +1,274 @@
+/* File: histogram_query.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_query.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_query.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+int histogram_query_create(histogram_query_t *q, int num_bins) {
+	if (num_bins < 1) {
+		return -1;
+	}
+	q->num_bins   = num_bins;
+	q->total      = 0;
+	q->mode       = 0;
+	q->mode_count = 0;
+	q->prefix     = (uint64_t *)calloc(num_bins, sizeof(uint64_t));
+	return q->prefix ? 0 : -2;
+}
+
+
+void histogram_query_release(histogram_query_t *q) {
+	free(q->prefix);
+	q->prefix = NULL;
+}
+
+
+#ifdef __AVX2__
+static inline __m256i query_load4(const BIN_DATA_TYPE *p) {
+	return _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)p));
+}
+static inline __m256i query_load4(const uint64_t *p) {
+	return _mm256_loadu_si256((const __m256i *)p);
+}
+#elif defined(__SSE2__)
+static inline __m128i query_load2(const BIN_DATA_TYPE *p) {
+	return _mm_unpacklo_epi32(_mm_loadl_epi64((const __m128i *)p), _mm_setzero_si128());
+}
+static inline __m128i query_load2(const uint64_t *p) {
+	return _mm_loadu_si128((const __m128i *)p);
+}
+#endif
+
+
+// Out[i] (+)= carry + In[0] + ... + In[i] for i < n; returns the last sum
+// added. Counts are non-negative, int bins are widened to 64 bits.
+template <typename T>
+static uint64_t query_scan(const T *In, uint64_t *Out, int n, uint64_t carry, bool accumulate) {
+	int i = 0;
+#ifdef __AVX2__
+	__m256i c = _mm256_set1_epi64x((long long)carry);
+	for (; i + 4 <= n; i += 4) {
+		__m256i x = query_load4(&In[i]);
+		x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+		// carry the low 128-bit lane total into the high lane
+		__m256i low = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(1, 1, 1, 1));
+		x = _mm256_add_epi64(x, _mm256_blend_epi32(_mm256_setzero_si256(), low, 0xF0));
+		x = _mm256_add_epi64(x, c);
+		c = _mm256_permute4x64_epi64(x, _MM_SHUFFLE(3, 3, 3, 3));
+		if (accumulate) {
+			x = _mm256_add_epi64(x, _mm256_loadu_si256((const __m256i *)&Out[i]));
+		}
+		_mm256_storeu_si256((__m256i *)&Out[i], x);
+	}
+	carry = (uint64_t)_mm256_extract_epi64(c, 0);
+#elif defined(__SSE2__)
+	__m128i c = _mm_set1_epi64x((long long)carry);
+	for (; i + 2 <= n; i += 2) {
+		__m128i x = query_load2(&In[i]);
+		x = _mm_add_epi64(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi64(x, c);
+		c = _mm_unpackhi_epi64(x, x);
+		if (accumulate) {
+			x = _mm_add_epi64(x, _mm_loadu_si128((const __m128i *)&Out[i]));
+		}
+		_mm_storeu_si128((__m128i *)&Out[i], x);
+	}
+	carry = (uint64_t)_mm_cvtsi128_si64(c);
+#endif
+	for (; i < n; i++) {
+		carry += (uint64_t)In[i];
+		Out[i] = accumulate ? Out[i] + carry : carry;
+	}
+	return carry;
+}
+
+
+// Out[i] += offset for i < n.
+static void query_offset(uint64_t *Out, int n, uint64_t offset) {
+	for (int i = 0; i < n; i++) {
+		Out[i] += offset;
+	}
+}
+
+
+// Prefix sum of In into (or added to) q->prefix. Large histograms are scanned
+// in two passes: every thread scans its block from zero, then adds the sum
+// of the blocks before it.
+template <typename T>
+static void query_prefix(histogram_query_t *q, const T *In, bool accumulate) {
+	int n = q->num_bins;
+	int num_threads = histogram_cpu_threads();
+
+	if (n < QUERY_PARALLEL_BINS || num_threads == 1) {
+		query_scan(In, q->prefix, n, 0, accumulate);
+		return;
+	}
+
+	uint64_t *block_sums = (uint64_t *)calloc(num_threads + 1, sizeof(uint64_t));
+	if (!block_sums) {
+		query_scan(In, q->prefix, n, 0, accumulate);
+		return;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(n, &begin, &end);
+		block_sums[tid + 1] = query_scan(&In[begin], &q->prefix[begin], (int)(end - begin), 0, accumulate);
+
+		#pragma omp barrier
+		uint64_t offset = 0;
+		for (int t = 0; t <= tid; t++) {
+			offset += block_sums[t];
+		}
+		if (offset) {
+			query_offset(&q->prefix[begin], (int)(end - begin), offset);
+		}
+	}
+	free(block_sums);
+}
+
+
+// Mode from the prefix sums. With delta, only bins that grew can overtake
+// the current mode, whose own count is refreshed first.
+template <typename T>
+static void query_mode(histogram_query_t *q, const T *Delta) {
+	if (Delta) {
+		q->mode_count = histogram_query_count(q, q->mode);
+	} else {
+		q->mode = 0;
+		q->mode_count = q->prefix[0];
+	}
+	for (int b = 1; b < q->num_bins; b++) {
+		if (Delta && !Delta[b]) {
+			continue;
+		}
+		uint64_t c = q->prefix[b] - q->prefix[b-1];
+		if (c > q->mode_count || (c == q->mode_count && b < q->mode)) {
+			q->mode = b;
+			q->mode_count = c;
+		}
+	}
+	if (Delta && Delta[0] && q->prefix[0] >= q->mode_count) {
+		q->mode = 0;
+		q->mode_count = q->prefix[0];
+	}
+}
+
+
+void histogram_query_build(histogram_query_t *q, const BIN_DATA_TYPE *Histogram) {
+	query_prefix(q, Histogram, false);
+	q->total = q->prefix[q->num_bins - 1];
+	query_mode(q, (const BIN_DATA_TYPE *)NULL);
+}
+
+
+void histogram_query_build_u64(histogram_query_t *q, const uint64_t *Histogram) {
+	query_prefix(q, Histogram, false);
+	q->total = q->prefix[q->num_bins - 1];
+	query_mode(q, (const uint64_t *)NULL);
+}
+
+
+void histogram_query_accumulate(histogram_query_t *q, const BIN_DATA_TYPE *Delta) {
+	query_prefix(q, Delta, true);
+	q->total = q->prefix[q->num_bins - 1];
+	query_mode(q, Delta);
+}
+
+
+void histogram_query_accumulate_u64(histogram_query_t *q, const uint64_t *Delta) {
+	query_prefix(q, Delta, true);
+	q->total = q->prefix[q->num_bins - 1];
+	query_mode(q, Delta);
+}
+
+
+// Smallest b with prefix[b] >= target.
+static int query_search(const histogram_query_t *q, uint64_t target) {
+	int lo = 0;
+	int hi = q->num_bins - 1;
+	while (lo < hi) {
+		int mid = lo + (hi - lo)/2;
+		if (q->prefix[mid] >= target) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+	return lo;
+}
+
+
+// p clamped to [0, 1]; NaN counts as 0.
+static double query_clamp(double p) {
+	if (!(p >= 0.0)) {
+		return 0.0;
+	}
+	return p > 1.0 ? 1.0 : p;
+}
+
+
+static uint64_t query_target(const histogram_query_t *q, double p) {
+	p = query_clamp(p);
+	uint64_t target = (uint64_t)ceil(p*(double)q->total);
+	return target < 1 ? 1 : target;
+}
+
+
+int histogram_query_quantile(const histogram_query_t *q, double p) {
+	if (q->total == 0) {
+		return -1;
+	}
+	return query_search(q, query_target(q, p));
+}
+
+
+double histogram_query_quantile_interp(const histogram_query_t *q, double p) {
+	if (q->total == 0) {
+		return -1.0;
+	}
+	p = query_clamp(p);
+	double target = p*(double)q->total;
+	int b = query_search(q, query_target(q, p));
+	uint64_t below = b ? q->prefix[b-1] : 0;
+	uint64_t count = q->prefix[b] - below;
+	double frac = ((double)target - (double)below)/(double)count;
+	if (frac < 0.0) {
+		frac = 0.0;
+	}
+	return b + frac;
+}
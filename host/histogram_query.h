@@ -0,0 +1,92 @@
+/* File: histogram_query.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_query.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_QUERY_h__
+#define __HISTOGRAM_QUERY_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Above this many bins the prefix sum is split across threads.
+#define QUERY_PARALLEL_BINS 65536
+
+// Query index over a computed histogram of any number of bins.
+// prefix[b] is the number of elements in bins 0..b, so rank and range counts
+// are O(1) and quantiles a binary search, O(log bins). The mode is kept
+// alongside. Further histograms can be accumulated into the index without
+// rebuilding it from the original bins.
+typedef struct {
+	int       num_bins;
+	uint64_t *prefix;
+	uint64_t  total;
+	int       mode;            // smallest bin with the highest count
+	uint64_t  mode_count;
+} histogram_query_t;
+
+// Returns 0 on success, -1 if num_bins < 1, -2 if allocation fails.
+int histogram_query_create(histogram_query_t *q, int num_bins);
+void histogram_query_release(histogram_query_t *q);
+
+// Replaces the indexed histogram (Histogram holds num_bins counts).
+void histogram_query_build(histogram_query_t *q, const BIN_DATA_TYPE *Histogram);
+void histogram_query_build_u64(histogram_query_t *q, const uint64_t *Histogram);
+
+// Adds Delta (num_bins counts) to the indexed histogram, e.g. the histogram
+// of the next batch of data. One pass over the bins.
+void histogram_query_accumulate(histogram_query_t *q, const BIN_DATA_TYPE *Delta);
+void histogram_query_accumulate_u64(histogram_query_t *q, const uint64_t *Delta);
+
+// Count of bin b.
+static inline uint64_t histogram_query_count(const histogram_query_t *q, int b) {
+	return b ? q->prefix[b] - q->prefix[b-1] : q->prefix[0];
+}
+
+// Number of elements in bins <= b (b clamped to the bin range).
+static inline uint64_t histogram_query_rank(const histogram_query_t *q, int b) {
+	if (b < 0) {
+		return 0;
+	}
+	return q->prefix[b < q->num_bins ? b : q->num_bins - 1];
+}
+
+// Number of elements in bins lo..hi inclusive.
+static inline uint64_t histogram_query_range(const histogram_query_t *q, int lo, int hi) {
+	if (hi < lo) {
+		return 0;
+	}
+	return histogram_query_rank(q, hi) - histogram_query_rank(q, lo - 1);
+}
+
+// Smallest bin b with rank(b) >= p*total, 0 <= p <= 1 (-1 if empty).
+// Percentile x is quantile(x/100).
+int histogram_query_quantile(const histogram_query_t *q, double p);
+
+// Same, interpolated linearly inside the bin: returns a fractional bin
+// position in [b, b+1], useful for medians of coarse histograms.
+double histogram_query_quantile_interp(const histogram_query_t *q, double p);
+
+#endif // __HISTOGRAM_QUERY_h__
@@ -0,0 +1,217 @@
+/* File: histogram_radix.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_radix.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_radix.h"
+#include "histogram_scatter.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+// Keys counted per round with 32-bit counters in the one-pass histogram.
+#define RADIX_ROUND_SIZE ((size_t)1 << 31)
+
+
+template <typename K>
+static int radix_digits(const K *Keys, size_t n, uint64_t *Digits) {
+	const int num_digits = sizeof(K);
+	int num_threads = histogram_cpu_threads();
+	uint64_t *partial = (uint64_t *)calloc((size_t)num_threads*num_digits*RADIX_BINS, sizeof(uint64_t));
+	if (!partial) {
+		return -2;
+	}
+
+	// every key updates one bin in each of the digit histograms
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(n, &begin, &end);
+		uint64_t *h = &partial[(size_t)tid*num_digits*RADIX_BINS];
+		unsigned int counts[sizeof(K)][RADIX_BINS];
+
+		// 32-bit counters, folded into h every RADIX_ROUND_SIZE keys
+		for (size_t round = begin; round < end; round += RADIX_ROUND_SIZE) {
+			size_t round_end = end - round < RADIX_ROUND_SIZE ? end : round + RADIX_ROUND_SIZE;
+			memset(counts, 0, sizeof(counts));
+			for (size_t i = round; i < round_end; i++) {
+				K k = Keys[i];
+				for (int d = 0; d < num_digits; d++) {
+					counts[d][(k >> (d*RADIX_BITS)) & (RADIX_BINS - 1)]++;
+				}
+			}
+			for (int d = 0; d < num_digits; d++) {
+				for (int b = 0; b < RADIX_BINS; b++) {
+					h[d*RADIX_BINS + b] += counts[d][b];
+				}
+			}
+		}
+	}
+
+	for (int j = 0; j < num_digits*RADIX_BINS; j++) {
+		uint64_t s = 0;
+		for (int t = 0; t < num_threads; t++) {
+			s += partial[(size_t)t*num_digits*RADIX_BINS + j];
+		}
+		Digits[j] = s;
+	}
+	free(partial);
+	return 0;
+}
+
+
+int histogram_radix_digits_u32(const uint32_t *Keys, size_t n, uint64_t *Digits) {
+	return radix_digits(Keys, n, Digits);
+}
+
+
+int histogram_radix_digits_u64(const uint64_t *Keys, size_t n, uint64_t *Digits) {
+	return radix_digits(Keys, n, Digits);
+}
+
+
+template <typename K>
+static int radix_sort(K *Keys, K *Scratch, size_t n, const uint64_t *Digits) {
+	const int num_digits = sizeof(K);
+	uint64_t local_digits[sizeof(K)*RADIX_BINS];
+	if (!Digits) {
+		if (radix_digits(Keys, n, local_digits) != 0) {
+			return -2;
+		}
+		Digits = local_digits;
+	}
+
+	// passes that would move nothing: every key has the same digit
+	int passes[sizeof(K)];
+	int num_passes = 0;
+	for (int d = 0; d < num_digits; d++) {
+		int trivial = 0;
+		for (int b = 0; b < RADIX_BINS; b++) {
+			trivial |= (Digits[d*RADIX_BINS + b] == n);
+		}
+		if (!trivial) {
+			passes[num_passes++] = d;
+		}
+	}
+	if (num_passes == 0 || n < 2) {
+		return 0;
+	}
+
+	int num_threads = histogram_cpu_threads();
+	size_t *offsets = (size_t *)malloc(sizeof(size_t)*num_threads*RADIX_BINS);
+	if (!offsets) {
+		return -2;
+	}
+	int err = 0;
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		int nth = 1;
+#ifdef _OPENMP
+		nth = omp_get_num_threads();
+#endif
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(n, &begin, &end);
+		size_t *off = &offsets[(size_t)tid*RADIX_BINS];
+		histogram_scatter_t wc;
+		int wc_err = histogram_scatter_create(&wc, RADIX_BINS);
+		if (wc_err) {
+			#pragma omp atomic write
+			err = wc_err;
+		}
+
+		K *src = Keys;
+		K *dst = Scratch;
+		for (int p = 0; p < num_passes; p++) {
+			int shift = passes[p]*RADIX_BITS;
+
+			// this thread's count of the digit; a single thread already has
+			// it in the one-pass histogram
+			if (nth == 1) {
+				for (int b = 0; b < RADIX_BINS; b++) {
+					off[b] = Digits[passes[p]*RADIX_BINS + b];
+				}
+			} else {
+				memset(off, 0, sizeof(size_t)*RADIX_BINS);
+				for (size_t i = begin; i < end; i++) {
+					off[(src[i] >> shift) & (RADIX_BINS - 1)]++;
+				}
+			}
+
+			// exclusive prefix sum over (bin, thread): the start of each
+			// thread's slice of every bucket
+			#pragma omp barrier
+			#pragma omp single
+			{
+				size_t running = 0;
+				for (int b = 0; b < RADIX_BINS; b++) {
+					for (int t = 0; t < nth; t++) {
+						size_t c = offsets[(size_t)t*RADIX_BINS + b];
+						offsets[(size_t)t*RADIX_BINS + b] = running;
+						running += c;
+					}
+				}
+			}
+
+			if (err == 0) {
+				histogram_scatter_begin(&wc, dst, off);
+				for (size_t i = begin; i < end; i++) {
+					K k = src[i];
+					histogram_scatter_push(&wc, dst, off, (int)((k >> shift) & (RADIX_BINS - 1)), k);
+				}
+				histogram_scatter_flush(&wc, dst, off);
+			}
+			#pragma omp barrier
+
+			K *t = src;
+			src = dst;
+			dst = t;
+		}
+
+		// odd number of passes: the result is in Scratch
+		if (err == 0 && src != Keys) {
+			memcpy(&Keys[begin], &src[begin], sizeof(K)*(end - begin));
+		}
+		if (wc_err == 0) {
+			histogram_scatter_release(&wc);
+		}
+	}
+
+	free(offsets);
+	return err;
+}
+
+
+int histogram_radix_sort_u32(uint32_t *Keys, uint32_t *Scratch, size_t n, const uint64_t *Digits) {
+	return radix_sort(Keys, Scratch, n, Digits);
+}
+
+
+int histogram_radix_sort_u64(uint64_t *Keys, uint64_t *Scratch, size_t n, const uint64_t *Digits) {
+	return radix_sort(Keys, Scratch, n, Digits);
+}
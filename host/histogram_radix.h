@@ -0,0 +1,53 @@
+/* File: histogram_radix.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_radix.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_RADIX_h__
+#define __HISTOGRAM_RADIX_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Byte digits: key bits 8d..8d+7 form digit d, d = 0 the least significant.
+#define RADIX_BITS 8
+#define RADIX_BINS (1 << RADIX_BITS)
+
+// All digit histograms of the keys in one pass over them:
+// Digits[d*RADIX_BINS + b] counts the keys whose digit d is b, for the 4
+// (u32) or 8 (u64) digits. Returns 0, or -2 if allocation fails.
+int histogram_radix_digits_u32(const uint32_t *Keys, size_t n, uint64_t *Digits);
+int histogram_radix_digits_u64(const uint64_t *Keys, size_t n, uint64_t *Digits);
+
+// LSD radix sort of n keys, ascending; Scratch holds n keys. The result is
+// left in Keys. Digits, if not NULL, are the precomputed digit histograms
+// (e.g. from histogram_device_digits); otherwise they are computed here.
+// Digits with a single populated bin are skipped. Each pass counts its
+// digit per thread, then scatters through write-combining buffers.
+// Returns 0, or -2 if allocation fails.
+int histogram_radix_sort_u32(uint32_t *Keys, uint32_t *Scratch, size_t n, const uint64_t *Digits);
+int histogram_radix_sort_u64(uint64_t *Keys, uint64_t *Scratch, size_t n, const uint64_t *Digits);
+
+#endif // __HISTOGRAM_RADIX_h__
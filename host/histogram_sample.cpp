@@ -0,0 +1,222 @@
+/* File: histogram_sample.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_sample.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_sample.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Full-period LCG modulo 2^walk_bits (Hull-Dobell: odd increment,
+// multiplier = 1 mod 4), its output scrambled by a bijection to hide the
+// short periods of the low bits; positions >= num_blocks are skipped.
+#define SAMPLE_LCG_MUL 6364136223846793005ULL
+#define SAMPLE_MIX_MUL 0x9E3779B97F4A7C15ULL
+
+
+static uint64_t sample_reverse_bits(uint64_t x, int bits) {
+	uint64_t r = 0;
+	for (int i = 0; i < bits; i++) {
+		r = (r << 1) | (x & 1);
+		x >>= 1;
+	}
+	return r;
+}
+
+
+// Next block of the walk, num_blocks once every block has been visited.
+static size_t sample_next_block(histogram_sample_t *s) {
+	uint64_t period = (uint64_t)1 << s->walk_bits;
+	while (s->walk_done < period) {
+		uint64_t block;
+		if (s->order == SAMPLE_RANDOM) {
+			int shift = (s->walk_bits + 1)/2;
+			block = s->walk ^ (s->walk >> shift);
+			block = (block*SAMPLE_MIX_MUL) & (period - 1);
+			block ^= block >> shift;
+			s->walk = (s->walk*SAMPLE_LCG_MUL + s->walk_step) & (period - 1);
+		} else {
+			block = sample_reverse_bits(s->walk_done, s->walk_bits);
+		}
+		s->walk_done++;
+		if (block < s->num_blocks) {
+			return (size_t)block;
+		}
+	}
+	return s->num_blocks;
+}
+
+
+static void sample_update(histogram_sample_t *s) {
+	double N = (double)s->num_blocks;
+	double m = (double)s->blocks_done;
+	double unseen = (double)(s->data_size - s->elements_done);
+	s->exact = s->elements_done == s->data_size;
+
+	for (int b = 0; b < BIN_SIZE; b++) {
+		double seen = (double)(s->tail[b] + s->sum[b]);
+		if (s->exact) {
+			s->estimate[b] = s->lower[b] = s->upper[b] = seen;
+			continue;
+		}
+		if (m == 0) {
+			s->estimate[b] = seen;
+			s->lower[b] = seen;
+			s->upper[b] = seen + unseen;
+			continue;
+		}
+		double mean = (double)s->sum[b]/m;
+		double var = m > 1 ? (s->sumsq[b] - m*mean*mean)/(m - 1) : 0;
+		double se = N*sqrt((var > 0 ? var : 0)*(1 - m/N)/m);
+		double half = SAMPLE_Z*se;
+		// a value absent from every sampled block: rule of three, at
+		// most 3/m of the remaining blocks, each full of it
+		if (s->sum[b] == 0) {
+			half = 3.0/m*unseen;
+		}
+		s->estimate[b] = (double)s->tail[b] + N*mean;
+		// the interval cannot leave what is already known
+		double lo = s->estimate[b] - half;
+		double hi = s->estimate[b] + half;
+		s->lower[b] = lo > seen ? lo : seen;
+		s->upper[b] = hi < seen + unseen ? hi : seen + unseen;
+	}
+}
+
+
+int histogram_sample_init(histogram_sample_t *sample, const INPUT_DATA_TYPE *Data, size_t data_size, size_t block_size, int order, uint64_t seed) {
+	if (order != SAMPLE_RANDOM && order != SAMPLE_STRIDED) {
+		return -1;
+	}
+	memset(sample, 0, sizeof(*sample));
+	if (block_size == 0) {
+		block_size = SAMPLE_BLOCK_SIZE;
+	}
+	sample->data_size  = data_size;
+	sample->block_size = block_size;
+	sample->num_blocks = data_size/block_size;
+	sample->order      = order;
+
+	while (((uint64_t)1 << sample->walk_bits) < sample->num_blocks) {
+		sample->walk_bits++;
+	}
+	uint64_t period = (uint64_t)1 << sample->walk_bits;
+	sample->walk      = (seed*SAMPLE_LCG_MUL >> 17) & (period - 1);
+	sample->walk_step = seed | 1;
+
+	size_t tail = sample->num_blocks*block_size;
+	for (size_t i = tail; i < data_size; i++) {
+		sample->tail[Data[i]]++;
+	}
+	sample->elements_done = data_size - tail;
+	sample_update(sample);
+	return 0;
+}
+
+
+size_t histogram_sample_step(histogram_sample_t *sample, const INPUT_DATA_TYPE *Data, size_t num_blocks) {
+	size_t left = sample->num_blocks - sample->blocks_done;
+	if (num_blocks > left) {
+		num_blocks = left;
+	}
+	if (num_blocks == 0) {
+		return 0;
+	}
+	size_t *blocks = (size_t *)malloc(sizeof(size_t)*num_blocks);
+	if (!blocks) {
+		return (size_t)-1;
+	}
+	for (size_t i = 0; i < num_blocks; i++) {
+		blocks[i] = sample_next_block(sample);
+	}
+
+	size_t block_size = sample->block_size;
+	int num_threads = histogram_cpu_threads();
+	if ((size_t)num_threads > num_blocks) {
+		num_threads = (int)num_blocks;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		uint64_t sum[BIN_SIZE];
+		double sumsq[BIN_SIZE];
+		BIN_DATA_TYPE counts[BIN_SIZE];
+		memset(sum, 0, sizeof(sum));
+		memset(sumsq, 0, sizeof(sumsq));
+
+		#pragma omp for schedule(dynamic, 1)
+		for (long i = 0; i < (long)num_blocks; i++) {
+			histogram_cpu_block(&Data[blocks[i]*block_size], counts, block_size);
+			for (int b = 0; b < BIN_SIZE; b++) {
+				uint64_t c = (uint64_t)counts[b];
+				sum[b]   += c;
+				sumsq[b] += (double)(c*c);
+			}
+		}
+
+		#pragma omp critical
+		for (int b = 0; b < BIN_SIZE; b++) {
+			sample->sum[b]   += sum[b];
+			sample->sumsq[b] += sumsq[b];
+		}
+	}
+	free(blocks);
+
+	sample->blocks_done   += num_blocks;
+	sample->elements_done += num_blocks*block_size;
+	sample_update(sample);
+	return num_blocks;
+}
+
+
+int histogram_sample_progressive(const INPUT_DATA_TYPE *Data, size_t data_size, size_t block_size, int order, uint64_t seed,
+		size_t blocks_per_snapshot, histogram_sample_fn fn, void *ctx) {
+	histogram_sample_t *sample = (histogram_sample_t *)malloc(sizeof(histogram_sample_t));
+	if (!sample) {
+		return -2;
+	}
+	int err = histogram_sample_init(sample, Data, data_size, block_size, order, seed);
+	if (blocks_per_snapshot == 0) {
+		blocks_per_snapshot = 1;
+	}
+	while (err == 0) {
+		size_t done = histogram_sample_step(sample, Data, blocks_per_snapshot);
+		if (done == (size_t)-1) {
+			err = -2;
+			break;
+		}
+		err = fn(sample, ctx);
+		if (sample->exact) {
+			break;
+		}
+	}
+	free(sample);
+	return err;
+}
@@ -0,0 +1,93 @@
+/* File: histogram_sample.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_sample.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_SAMPLE_h__
+#define __HISTOGRAM_SAMPLE_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Elements per sampled block. Whole blocks are sampled (cluster sampling),
+// so every block is one sequential read.
+#define SAMPLE_BLOCK_SIZE 65536
+// Two-sided 95% normal quantile for the confidence intervals.
+#define SAMPLE_Z 1.96
+
+// Order in which the blocks are visited. Both visit every block exactly
+// once, so a run that is not stopped ends with the exact histogram.
+#define SAMPLE_RANDOM  0   // pseudo-random permutation
+#define SAMPLE_STRIDED 1   // evenly spread, each round halving the stride
+
+// Approximate histogram from the blocks visited so far. The block counts of
+// a bin are summed and squared-summed, giving the estimate N*mean and its
+// standard error N*sqrt((1 - m/N) var/m) for m of N blocks sampled; with the
+// finite population correction the interval closes to the exact count once
+// every block has been seen. The incomplete last block is counted first,
+// exactly, and kept out of the estimate.
+typedef struct {
+	size_t   data_size;
+	size_t   block_size;
+	size_t   num_blocks;     // full blocks
+	size_t   blocks_done;
+	uint64_t elements_done;
+	int      exact;          // every element has been counted
+	double   estimate[BIN_SIZE];
+	double   lower[BIN_SIZE];
+	double   upper[BIN_SIZE];
+
+	// internal state
+	int      order;
+	int      walk_bits;
+	uint64_t walk;
+	uint64_t walk_step;
+	uint64_t walk_done;
+	uint64_t tail[BIN_SIZE];
+	uint64_t sum[BIN_SIZE];
+	double   sumsq[BIN_SIZE];
+} histogram_sample_t;
+
+// Called with every snapshot; a nonzero return stops the refinement.
+typedef int (*histogram_sample_fn)(const histogram_sample_t *sample, void *ctx);
+
+// Prepares sampling of data_size elements (block_size 0 means
+// SAMPLE_BLOCK_SIZE) and counts the incomplete last block.
+// Returns 0, -1 for an unknown order.
+int histogram_sample_init(histogram_sample_t *sample, const INPUT_DATA_TYPE *Data, size_t data_size, size_t block_size, int order, uint64_t seed);
+
+// Counts up to num_blocks more blocks in parallel and updates the estimate
+// and intervals. Returns the number of blocks counted, 0 once exact,
+// (size_t)-1 if allocation fails.
+size_t histogram_sample_step(histogram_sample_t *sample, const INPUT_DATA_TYPE *Data, size_t num_blocks);
+
+// Anytime histogram: counts blocks_per_snapshot blocks at a time and hands
+// every snapshot to fn, until the histogram is exact or fn returns nonzero.
+// Returns 0, fn's return value, -1 for an unknown order, -2 if allocation
+// fails.
+int histogram_sample_progressive(const INPUT_DATA_TYPE *Data, size_t data_size, size_t block_size, int order, uint64_t seed,
+		size_t blocks_per_snapshot, histogram_sample_fn fn, void *ctx);
+
+#endif // __HISTOGRAM_SAMPLE_h__
@@ -0,0 +1,140 @@
+/* File: histogram_scatter.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_scatter.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_SCATTER_h__
+#define __HISTOGRAM_SCATTER_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Size of one write-combining buffer; the element size has to divide it
+// and the destination has to be aligned to the element size.
+#define SCATTER_LINE_BYTES 64
+
+// Software write-combining for the scatter phase of histogram-driven
+// algorithms (radix sort, partitioning): elements bound for a bucket are
+// staged in a cache line sized buffer and written out a whole destination
+// line at a time, instead of one scattered store per element touching
+// num_buckets lines at once. The first flush of a bucket stops at a line
+// boundary of the destination, so later ones are aligned whole lines and go
+// out as non-temporal stores, skipping the read for ownership.
+// One instance per thread.
+typedef struct {
+	int            num_buckets;
+	unsigned char *lines;      // num_buckets x SCATTER_LINE_BYTES, line aligned
+	unsigned int  *fill;       // elements staged per bucket
+	unsigned int  *limit;      // flush threshold: up to the next destination line boundary
+	void          *raw;
+} histogram_scatter_t;
+
+static inline void histogram_scatter_release(histogram_scatter_t *wc) {
+	free(wc->raw);
+	free(wc->fill);
+	wc->raw  = NULL;
+	wc->fill = NULL;
+}
+
+// Returns 0 on success, -2 if allocation fails; either way wc can be
+// passed to histogram_scatter_release.
+static inline int histogram_scatter_create(histogram_scatter_t *wc, int num_buckets) {
+	memset(wc, 0, sizeof(*wc));
+	wc->num_buckets = num_buckets;
+	wc->raw   = malloc((size_t)num_buckets*SCATTER_LINE_BYTES + SCATTER_LINE_BYTES);
+	wc->fill  = (unsigned int *)malloc(sizeof(unsigned int)*2*num_buckets);
+	if (!wc->raw || !wc->fill) {
+		histogram_scatter_release(wc);
+		return -2;
+	}
+	wc->lines = (unsigned char *)(((uintptr_t)wc->raw + SCATTER_LINE_BYTES - 1) & ~(uintptr_t)(SCATTER_LINE_BYTES - 1));
+	wc->limit = &wc->fill[num_buckets];
+	return 0;
+}
+
+// Starts a scatter into Out; offsets[b] is where this thread's next element
+// of bucket b goes and is advanced as lines are written.
+template <typename T>
+static inline void histogram_scatter_begin(histogram_scatter_t *wc, T *Out, const size_t *offsets) {
+	for (int b = 0; b < wc->num_buckets; b++) {
+		size_t misalign = ((uintptr_t)&Out[offsets[b]] % SCATTER_LINE_BYTES)/sizeof(T);
+		wc->fill[b]  = 0;
+		wc->limit[b] = (unsigned int)(SCATTER_LINE_BYTES/sizeof(T) - misalign);
+	}
+}
+
+template <typename T>
+static inline void histogram_scatter_push(histogram_scatter_t *wc, T *Out, size_t *offsets, int bucket, const T &value) {
+	unsigned char *lines = wc->lines;
+	unsigned int  *fill  = wc->fill;
+	unsigned int  *limit = wc->limit;
+	T *line = (T *)&lines[(size_t)bucket*SCATTER_LINE_BYTES];
+	unsigned int f = fill[bucket];
+	unsigned int l = limit[bucket];
+	line[f++] = value;
+	if (f == l) {
+		if (l == SCATTER_LINE_BYTES/sizeof(T)) {
+#ifdef __SSE2__
+			__m128i *dst = (__m128i *)&Out[offsets[bucket]];
+			const __m128i *src = (const __m128i *)line;
+			_mm_stream_si128(&dst[0], src[0]);
+			_mm_stream_si128(&dst[1], src[1]);
+			_mm_stream_si128(&dst[2], src[2]);
+			_mm_stream_si128(&dst[3], src[3]);
+#else
+			memcpy(&Out[offsets[bucket]], line, SCATTER_LINE_BYTES);
+#endif
+		} else {
+			memcpy(&Out[offsets[bucket]], line, f*sizeof(T));
+			limit[bucket] = SCATTER_LINE_BYTES/sizeof(T);
+		}
+		offsets[bucket] += f;
+		f = 0;
+	}
+	fill[bucket] = f;
+}
+
+// Writes out the partially filled lines; call once the thread has pushed
+// all of its elements.
+template <typename T>
+static inline void histogram_scatter_flush(histogram_scatter_t *wc, T *Out, size_t *offsets) {
+	for (int b = 0; b < wc->num_buckets; b++) {
+		unsigned int f = wc->fill[b];
+		if (f) {
+			memcpy(&Out[offsets[b]], &wc->lines[(size_t)b*SCATTER_LINE_BYTES], f*sizeof(T));
+			offsets[b] += f;
+			wc->fill[b] = 0;
+		}
+	}
+#ifdef __SSE2__
+	_mm_sfence();
+#endif
+}
+
+#endif // __HISTOGRAM_SCATTER_h__
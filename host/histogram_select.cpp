@@ -0,0 +1,306 @@
+/* File: histogram_select.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_select.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_select.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// Order-preserving maps from the input type to an unsigned key.
+struct select_u32 {
+	typedef uint32_t key_t;
+	key_t    operator()(uint32_t x) const { return x; }
+	uint32_t value(key_t k) const         { return k; }
+};
+
+struct select_u64 {
+	typedef uint64_t key_t;
+	key_t    operator()(uint64_t x) const { return x; }
+	uint64_t value(key_t k) const         { return k; }
+};
+
+// Negative floats have all bits flipped, positive ones the sign bit only.
+struct select_float {
+	typedef uint32_t key_t;
+	key_t operator()(float x) const {
+		uint32_t u;
+		memcpy(&u, &x, sizeof(u));
+		return u ^ ((uint32_t)((int32_t)u >> 31) | 0x80000000u);
+	}
+	float value(key_t k) const {
+		uint32_t u = (k & 0x80000000u) ? (k ^ 0x80000000u) : ~k;
+		float x;
+		memcpy(&x, &u, sizeof(x));
+		return x;
+	}
+};
+
+// Keys already mapped, for the survivor passes.
+template <typename K>
+struct select_key {
+	K operator()(K k) const { return k; }
+};
+
+
+template <typename K, typename S, typename M>
+static void select_count(const S *In, size_t begin, size_t end, M map, int shift, K mask, size_t *h) {
+	memset(h, 0, sizeof(size_t)*SELECT_BINS);
+	for (size_t i = begin; i < end; i++) {
+		h[(map(In[i]) >> shift) & mask]++;
+	}
+}
+
+
+// Copies the keys of bucket b to Out and histograms their next digit.
+template <typename K, typename S, typename M>
+static void select_compact(const S *In, size_t begin, size_t end, M map, int shift, K mask, K b,
+                           K *Out, int next_shift, K next_mask, size_t *h) {
+	memset(h, 0, sizeof(size_t)*SELECT_BINS);
+	size_t o = 0;
+	for (size_t i = begin; i < end; i++) {
+		K k = map(In[i]);
+		if (((k >> shift) & mask) == b) {
+			Out[o++] = k;
+			h[(k >> next_shift) & next_mask]++;
+		}
+	}
+}
+
+
+// Bucket of the per-thread histograms h that holds rank *k; *k becomes the
+// rank inside it, *above the number of keys in higher buckets.
+static int select_bucket(const size_t *h, int num_threads, size_t *k, size_t *count, size_t *above, size_t total) {
+	size_t below = 0;
+	for (int b = 0; b < SELECT_BINS; b++) {
+		size_t c = 0;
+		for (int t = 0; t < num_threads; t++) {
+			c += h[(size_t)t*SELECT_BINS + b];
+		}
+		if (*k < below + c) {
+			*k -= below;
+			*count = c;
+			*above += total - below - c;
+			return b;
+		}
+		below += c;
+	}
+	return SELECT_BINS - 1;
+}
+
+
+// One narrowing round: the keys of bucket b in the ranges bounds[t] ..
+// bounds[t+1] of In go to the new buffer, range by range, so range t of the
+// survivors is exactly what h_next[t] counted; next_bounds receives them.
+template <typename K, typename S, typename M>
+static K *select_round(const S *In, const size_t *bounds, M map, int num_ranges, size_t *h, size_t *h_next, size_t *next_bounds,
+                       int shift, K mask, K b, size_t count, int next_shift, K next_mask) {
+	K *Out = (K *)malloc(sizeof(K)*(count ? count : 1));
+	if (!Out) {
+		return NULL;
+	}
+	size_t offset = 0;
+	for (int t = 0; t < num_ranges; t++) {
+		next_bounds[t] = offset;
+		offset += h[(size_t)t*SELECT_BINS + b];
+	}
+	next_bounds[num_ranges] = offset;
+
+	#pragma omp parallel for schedule(static) num_threads(num_ranges)
+	for (int t = 0; t < num_ranges; t++) {
+		select_compact(In, bounds[t], bounds[t + 1], map, shift, mask, b, &Out[next_bounds[t]], next_shift, next_mask, &h_next[(size_t)t*SELECT_BINS]);
+	}
+	return Out;
+}
+
+
+// The key of rank k; *above receives the number of keys greater than it.
+template <typename S, typename M>
+static int select_kth(const S *In, size_t n, size_t k, M map, typename M::key_t *Key, size_t *above) {
+	typedef typename M::key_t K;
+	const int bits = 8*sizeof(K);
+
+	if (k >= n) {
+		return -1;
+	}
+	int num_threads = histogram_cpu_threads();
+	size_t *h = (size_t *)calloc((size_t)2*num_threads*SELECT_BINS + 2*(num_threads + 1), sizeof(size_t));
+	if (!h) {
+		return -2;
+	}
+	size_t *h_next = &h[(size_t)num_threads*SELECT_BINS];
+	size_t *bounds = &h[(size_t)2*num_threads*SELECT_BINS];
+	size_t *next_bounds = &bounds[num_threads + 1];
+	size_t *base = h;
+
+	int shift = bits - SELECT_BITS;
+	K mask = (K)SELECT_BINS - 1;
+	K prefix = 0;
+	*above = 0;
+
+	for (int t = 0; t <= num_threads; t++) {
+		bounds[t] = n*t/num_threads;
+	}
+	#pragma omp parallel for schedule(static) num_threads(num_threads)
+	for (int t = 0; t < num_threads; t++) {
+		select_count(In, bounds[t], bounds[t + 1], map, shift, mask, &h[(size_t)t*SELECT_BINS]);
+	}
+
+	K *surv = NULL;
+	size_t m = n;
+	int err = 0;
+	for (;;) {
+		size_t count = 0;
+		K b = (K)select_bucket(h, num_threads, &k, &count, above, m);
+		prefix |= b << shift;
+		if (shift == 0) {
+			*Key = prefix;
+			break;
+		}
+
+		int next_shift = shift > SELECT_BITS ? shift - SELECT_BITS : 0;
+		K next_mask = ((K)1 << (shift - next_shift)) - 1;
+		K *next = surv ? select_round(surv, bounds, select_key<K>(), num_threads, h, h_next, next_bounds, shift, mask, b, count, next_shift, next_mask)
+		               : select_round(In, bounds, map, num_threads, h, h_next, next_bounds, shift, mask, b, count, next_shift, next_mask);
+		free(surv);
+		surv = next;
+		if (!next) {
+			err = -2;
+			break;
+		}
+		m = count;
+		shift = next_shift;
+		mask = next_mask;
+		size_t *t = h;
+		h = h_next;
+		h_next = t;
+		t = bounds;
+		bounds = next_bounds;
+		next_bounds = t;
+
+		// a single survivor is the answer, no need to resolve the low digits
+		if (m == 1) {
+			*Key = surv[0];
+			break;
+		}
+	}
+
+	free(surv);
+	free(base);
+	return err;
+}
+
+
+// Buffered output of the top-k collection pass, flushed to the shared
+// position with one atomic per SELECT_FLUSH values.
+#define SELECT_FLUSH 256
+
+template <typename S, typename M>
+static int select_topk(const S *In, size_t n, size_t k, M map, S *Out) {
+	typedef typename M::key_t K;
+	if (k > n) {
+		return -1;
+	}
+	if (k == 0) {
+		return 0;
+	}
+
+	K threshold;
+	size_t above;
+	int err = select_kth(In, n, n - k, map, &threshold, &above);
+	if (err) {
+		return err;
+	}
+
+	// the `above` values greater than the threshold, then copies of it
+	size_t next = 0;
+	#pragma omp parallel
+	{
+		size_t begin, end;
+		histogram_cpu_thread_range(n, &begin, &end);
+		S buffer[SELECT_FLUSH];
+		size_t fill = 0;
+		for (size_t i = begin; i <= end; i++) {
+			if (i < end && map(In[i]) > threshold) {
+				buffer[fill++] = In[i];
+				if (fill < SELECT_FLUSH) {
+					continue;
+				}
+			} else if (i < end || fill == 0) {
+				continue;
+			}
+			size_t pos;
+			#pragma omp atomic capture
+			{ pos = next; next += fill; }
+			memcpy(&Out[pos], buffer, sizeof(S)*fill);
+			fill = 0;
+		}
+	}
+
+	S v = map.value(threshold);
+	for (size_t i = above; i < k; i++) {
+		Out[i] = v;
+	}
+	return 0;
+}
+
+
+int histogram_select_u32(const uint32_t *Data, size_t n, size_t k, uint32_t *Value) {
+	size_t above;
+	return select_kth(Data, n, k, select_u32(), Value, &above);
+}
+
+
+int histogram_select_u64(const uint64_t *Data, size_t n, size_t k, uint64_t *Value) {
+	size_t above;
+	return select_kth(Data, n, k, select_u64(), Value, &above);
+}
+
+
+int histogram_select_float(const float *Data, size_t n, size_t k, float *Value) {
+	size_t above;
+	uint32_t key;
+	int err = select_kth(Data, n, k, select_float(), &key, &above);
+	if (err == 0) {
+		*Value = select_float().value(key);
+	}
+	return err;
+}
+
+
+int histogram_select_topk_u32(const uint32_t *Data, size_t n, size_t k, uint32_t *Out) {
+	return select_topk(Data, n, k, select_u32(), Out);
+}
+
+
+int histogram_select_topk_u64(const uint64_t *Data, size_t n, size_t k, uint64_t *Out) {
+	return select_topk(Data, n, k, select_u64(), Out);
+}
+
+
+int histogram_select_topk_float(const float *Data, size_t n, size_t k, float *Out) {
+	return select_topk(Data, n, k, select_float(), Out);
+}
@@ -0,0 +1,56 @@
+/* File: histogram_select.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_select.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_SELECT_h__
+#define __HISTOGRAM_SELECT_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram.h"
+
+// Digit width of the select passes: 2048 bins per thread, L1 resident.
+#define SELECT_BITS 11
+#define SELECT_BINS (1 << SELECT_BITS)
+
+// Radix select: the k-th smallest value (k = 0 the minimum) of n values,
+// without sorting. The histogram of the top digit locates the bucket that
+// holds rank k; only that bucket's elements are compacted, and the
+// compaction already histograms their next digit. Typically the input is
+// read twice and later passes touch only the survivors.
+// Floats are ordered by their IEEE bits (-0 < +0, NaNs at the ends).
+// Returns 0, -1 if k >= n, -2 if allocation fails.
+int histogram_select_u32(const uint32_t *Data, size_t n, size_t k, uint32_t *Value);
+int histogram_select_u64(const uint64_t *Data, size_t n, size_t k, uint64_t *Value);
+int histogram_select_float(const float *Data, size_t n, size_t k, float *Value);
+
+// The k largest values of Data in Out[k], in no particular order: a select
+// of rank n-k followed by one pass collecting the larger values.
+// Returns 0, -1 if k > n, -2 if allocation fails.
+int histogram_select_topk_u32(const uint32_t *Data, size_t n, size_t k, uint32_t *Out);
+int histogram_select_topk_u64(const uint64_t *Data, size_t n, size_t k, uint64_t *Out);
+int histogram_select_topk_float(const float *Data, size_t n, size_t k, float *Out);
+
+#endif // __HISTOGRAM_SELECT_h__
@@ -0,0 +1,231 @@
+/* File: histogram_sparse.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_sparse.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_sparse.h"
+#include "histogram_cpu.h"
+#include "histogram_hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+static int sparse_alloc(histogram_sparse_t *result, size_t size) {
+	result->size   = size;
+	result->keys   = (uint64_t *)malloc(sizeof(uint64_t)*(size ? size : 1));
+	result->counts = (uint64_t *)malloc(sizeof(uint64_t)*(size ? size : 1));
+	if (!result->keys || !result->counts) {
+		histogram_sparse_release(result);
+		return -2;
+	}
+	return 0;
+}
+
+
+template <typename K>
+static int sparse_dense(const K *Keys, size_t data_size, uint64_t key_min, size_t range, histogram_sparse_t *result) {
+
+	int num_threads = histogram_cpu_threads();
+	unsigned int *partial = (unsigned int *)calloc((size_t)num_threads*range, sizeof(unsigned int));
+	uint64_t *merged = (uint64_t *)malloc(sizeof(uint64_t)*range);
+	if (!partial || !merged) {
+		free(partial);
+		free(merged);
+		return -2;
+	}
+
+	#pragma omp parallel num_threads(num_threads)
+	{
+		size_t begin, end;
+		int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+		unsigned int *h = partial + tid*range;
+		for (size_t i = begin; i < end; i++) {
+			h[(size_t)(Keys[i] - key_min)]++;
+		}
+
+		#pragma omp barrier
+
+		#pragma omp for schedule(static)
+		for (long j = 0; j < (long)range; j++) {
+			uint64_t sum = 0;
+			for (int t = 0; t < num_threads; t++) {
+				sum += partial[t*range + j];
+			}
+			merged[j] = sum;
+		}
+	}
+	free(partial);
+
+	size_t size = 0;
+	for (size_t j = 0; j < range; j++) {
+		size += (merged[j] != 0);
+	}
+	int err = sparse_alloc(result, size);
+	if (err == 0) {
+		size_t k = 0;
+		for (size_t j = 0; j < range; j++) {
+			if (merged[j]) {
+				result->keys[k]   = key_min + j;
+				result->counts[k] = merged[j];
+				k++;
+			}
+		}
+	}
+	free(merged);
+	return err;
+}
+
+
+template <typename K>
+static int sparse_hashed(const K *Keys, size_t data_size, histogram_sparse_t *result) {
+
+	int num_threads = histogram_cpu_threads();
+	int shift = 64;
+	for (int p = SPARSE_PARTITIONS; p > 1; p /= 2) {
+		shift--;
+	}
+	histogram_hash_t *tables = (histogram_hash_t *)calloc((size_t)num_threads*SPARSE_PARTITIONS, sizeof(histogram_hash_t));
+	histogram_hash_t *merged = (histogram_hash_t *)calloc(SPARSE_PARTITIONS, sizeof(histogram_hash_t));
+	size_t offset[SPARSE_PARTITIONS+1];
+	int err = (tables && merged) ? 0 : -2;
+
+	for (int k = 0; err == 0 && k < num_threads*SPARSE_PARTITIONS; k++) {
+		err |= histogram_hash_create(&tables[k], 256);
+	}
+
+	if (err == 0) {
+		#pragma omp parallel num_threads(num_threads)
+		{
+			size_t begin, end;
+			int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+			histogram_hash_t *own = &tables[tid*SPARSE_PARTITIONS];
+
+			for (size_t i = begin; i < end; i++) {
+				uint64_t key  = Keys[i];
+				uint64_t hash = histogram_hash_mix(key);
+				if (histogram_hash_add_hashed(&own[hash >> shift], key, hash, 1) != 0) {
+					#pragma omp atomic
+					err |= 1;
+					break;
+				}
+			}
+
+			#pragma omp barrier
+
+			// a partition holds a disjoint key set: merge each one independently
+			#pragma omp for schedule(dynamic, 1) reduction(|:err)
+			for (int p = 0; p < SPARSE_PARTITIONS; p++) {
+				size_t size = 0;
+				for (int t = 0; t < num_threads; t++) {
+					size += tables[t*SPARSE_PARTITIONS + p].size;
+				}
+				if (histogram_hash_create(&merged[p], 2*size) != 0) {
+					err |= 1;
+					continue;
+				}
+				for (int t = 0; t < num_threads; t++) {
+					histogram_hash_t *table = &tables[t*SPARSE_PARTITIONS + p];
+					for (size_t s = 0; s <= table->mask; s++) {
+						if (table->slots[s].count) {
+							err |= histogram_hash_add(&merged[p], table->slots[s].key, table->slots[s].count) != 0;
+						}
+					}
+					histogram_hash_release(table);
+				}
+			}
+		}
+	}
+
+	if (err == 0) {
+		offset[0] = 0;
+		for (int p = 0; p < SPARSE_PARTITIONS; p++) {
+			offset[p+1] = offset[p] + merged[p].size;
+		}
+		err = sparse_alloc(result, offset[SPARSE_PARTITIONS]);
+	}
+	if (err == 0) {
+		#pragma omp parallel for schedule(dynamic, 1)
+		for (int p = 0; p < SPARSE_PARTITIONS; p++) {
+			size_t k = offset[p];
+			for (size_t s = 0; s <= merged[p].mask; s++) {
+				if (merged[p].slots[s].count) {
+					result->keys[k]   = merged[p].slots[s].key;
+					result->counts[k] = merged[p].slots[s].count;
+					k++;
+				}
+			}
+		}
+	}
+
+	for (int k = 0; tables && k < num_threads*SPARSE_PARTITIONS; k++) {
+		histogram_hash_release(&tables[k]);
+	}
+	for (int p = 0; merged && p < SPARSE_PARTITIONS; p++) {
+		histogram_hash_release(&merged[p]);
+	}
+	free(tables);
+	free(merged);
+	return err ? -2 : 0;
+}
+
+
+template <typename K>
+static int sparse_histogram(const K *Keys, size_t data_size, histogram_sparse_t *result) {
+
+	K key_min = (K)~(K)0;
+	K key_max = 0;
+
+	#pragma omp parallel for reduction(min:key_min) reduction(max:key_max)
+	for (long i = 0; i < (long)data_size; i++) {
+		key_min = Keys[i] < key_min ? Keys[i] : key_min;
+		key_max = Keys[i] > key_max ? Keys[i] : key_max;
+	}
+
+	if (data_size == 0) {
+		return sparse_alloc(result, 0);
+	}
+	if ((uint64_t)(key_max - key_min) < SPARSE_DENSE_RANGE) {
+		return sparse_dense(Keys, data_size, (uint64_t)key_min, (size_t)(key_max - key_min) + 1, result);
+	}
+	return sparse_hashed(Keys, data_size, result);
+}
+
+
+int histogram_sparse_u32(const uint32_t *Keys, size_t data_size, histogram_sparse_t *result) {
+	return sparse_histogram(Keys, data_size, result);
+}
+
+
+int histogram_sparse_u64(const uint64_t *Keys, size_t data_size, histogram_sparse_t *result) {
+	return sparse_histogram(Keys, data_size, result);
+}
+
+
+void histogram_sparse_release(histogram_sparse_t *result) {
+	free(result->keys);
+	free(result->counts);
+	result->keys   = NULL;
+	result->counts = NULL;
+	result->size   = 0;
+}
@@ -0,0 +1,55 @@
+/* File: histogram_sparse.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_sparse.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_SPARSE_h__
+#define __HISTOGRAM_SPARSE_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Key ranges (max - min + 1) up to this size are counted in dense arrays.
+#define SPARSE_DENSE_RANGE 65536
+// Number of radix partitions of the hash space, a power of two.
+#define SPARSE_PARTITIONS  64
+
+// Histogram of 32/64-bit keys as (key, count) pairs with a non-zero count.
+typedef struct {
+	size_t    size;
+	uint64_t *keys;
+	uint64_t *counts;
+} histogram_sparse_t;
+
+// A first pass finds the key range. If it is small, the keys are counted in
+// per-thread dense arrays and the result comes out sorted by key. Otherwise
+// every thread counts into open-addressing tables, one per radix partition
+// (top bits of the key hash), and each partition is merged by one thread;
+// the result is then grouped by partition, not sorted.
+// Returns 0 on success, -2 if allocation fails.
+int histogram_sparse_u32(const uint32_t *Keys, size_t data_size, histogram_sparse_t *result);
+int histogram_sparse_u64(const uint64_t *Keys, size_t data_size, histogram_sparse_t *result);
+void histogram_sparse_release(histogram_sparse_t *result);
+
+#endif // __HISTOGRAM_SPARSE_h__
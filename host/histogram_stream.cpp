@@ -0,0 +1,87 @@
+/* File: histogram_stream.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_stream.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_stream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+
+int histogram_stream_file(const char *filename, size_t chunk_size, size_t overlap, histogram_stream_fn fn, void *ctx) {
+
+	if (chunk_size == 0) {
+		return -1;
+	}
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL) {
+		return -1;
+	}
+	unsigned char *buffer = (unsigned char *)malloc(overlap + chunk_size);
+	if (!buffer) {
+		fclose(f);
+		return -2;
+	}
+
+	size_t   carried = 0;        // bytes kept from the previous chunk
+	uint64_t offset  = 0;        // file position of buffer[0]
+	int      err     = 0;
+
+	for (;;) {
+		size_t got = fread(&buffer[carried], 1, chunk_size, f);
+		if (got == 0) {
+			break;
+		}
+		size_t size = carried + got;
+		err = fn(buffer, size, offset, ctx);
+		if (err || got < chunk_size) {
+			break;
+		}
+		size_t keep = size < overlap ? size : overlap;
+		memmove(buffer, &buffer[size - keep], keep);
+		offset += size - keep;
+		carried = keep;
+	}
+	if (!err && ferror(f)) {
+		err = -2;
+	}
+
+	free(buffer);
+	fclose(f);
+	return err;
+}
+
+
+int64_t histogram_stream_file_size(const char *filename) {
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL) {
+		return -1;
+	}
+	fseeko(f, 0, SEEK_END);
+	int64_t size = (int64_t)ftello(f);
+	fclose(f);
+	return size;
+}
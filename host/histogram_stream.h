@@ -0,0 +1,51 @@
+/* File: histogram_stream.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_stream.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_STREAM_h__
+#define __HISTOGRAM_STREAM_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Default number of new bytes read per chunk.
+#define STREAM_CHUNK_SIZE (64 << 20)
+
+// Called once per chunk. data holds the last `overlap` bytes of the previous
+// chunk (fewer at the start of the file) followed by the new bytes; offset is
+// the file position of data[0]. A nonzero return stops the stream.
+typedef int (*histogram_stream_fn)(const unsigned char *data, size_t size, uint64_t offset, void *ctx);
+
+// Streams a file of any size through a fixed buffer of overlap + chunk_size
+// bytes, so that windows up to overlap + 1 bytes long never miss a chunk
+// boundary. Returns 0 at end of file, -1 if the file cannot be opened or
+// chunk_size is 0, -2 if allocation or reading fails, otherwise the
+// callback's return value.
+int histogram_stream_file(const char *filename, size_t chunk_size, size_t overlap, histogram_stream_fn fn, void *ctx);
+
+// Size of a file in bytes, -1 if it cannot be opened.
+int64_t histogram_stream_file_size(const char *filename);
+
+#endif // __HISTOGRAM_STREAM_h__
@@ -0,0 +1,168 @@
+/* File: histogram_tiled.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_tiled.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_tiled.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+
+static int tiled_valid(int width, int height, int pitch, int tiles_x, int tiles_y) {
+	return width > 0 && height > 0 && pitch >= width &&
+	       tiles_x > 0 && tiles_y > 0 && tiles_x <= width && tiles_y <= height;
+}
+
+
+int histogram_tiled(const unsigned char *Image, int width, int height, int pitch,
+                    int tiles_x, int tiles_y, BIN_DATA_TYPE *Histograms) {
+
+	if (!tiled_valid(width, height, pitch, tiles_x, tiles_y)) {
+		return -1;
+	}
+
+	#pragma omp parallel
+	{
+		unsigned int h[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+
+		#pragma omp for schedule(dynamic, 1)
+		for (int ty = 0; ty < tiles_y; ty++) {
+			int y0 = ty*height/tiles_y;
+			int y1 = (ty+1)*height/tiles_y;
+
+			for (int tx = 0; tx < tiles_x; tx++) {
+				int x0 = tx*width/tiles_x;
+				int x1 = (tx+1)*width/tiles_x;
+
+				memset(h, 0, sizeof(h));
+				for (int y = y0; y < y1; y++) {
+					const unsigned char *row = Image + (size_t)y*pitch;
+					int x = x0;
+					for (; x + 4 <= x1; x += 4) {
+						h[0*BIN_SIZE + row[x  ]]++;
+						h[1*BIN_SIZE + row[x+1]]++;
+						h[2*BIN_SIZE + row[x+2]]++;
+						h[3*BIN_SIZE + row[x+3]]++;
+					}
+					for (; x < x1; x++) {
+						h[row[x]]++;
+					}
+				}
+
+				BIN_DATA_TYPE *out = Histograms + ((size_t)ty*tiles_x + tx)*BIN_SIZE;
+				for (int j = 0; j < BIN_SIZE; j++) {
+					out[j] = h[0*BIN_SIZE + j] + h[1*BIN_SIZE + j] + h[2*BIN_SIZE + j] + h[3*BIN_SIZE + j];
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+
+void histogram_tiled_clip(BIN_DATA_TYPE *Histograms, int num_tiles, int clip_limit, unsigned char *Luts) {
+
+	#pragma omp parallel for schedule(static)
+	for (int t = 0; t < num_tiles; t++) {
+		BIN_DATA_TYPE *h = Histograms + (size_t)t*BIN_SIZE;
+		BIN_DATA_TYPE excess = 0;
+		BIN_DATA_TYPE total  = 0;
+
+		for (int j = 0; j < BIN_SIZE; j++) {
+			total += h[j];
+			if (h[j] > clip_limit) {
+				excess += h[j] - clip_limit;
+				h[j] = clip_limit;
+			}
+		}
+
+		// uniform share for every bin, the remainder spread with a fixed step
+		BIN_DATA_TYPE share    = excess/BIN_SIZE;
+		BIN_DATA_TYPE residual = excess - share*BIN_SIZE;
+		int step = (residual > 0) ? BIN_SIZE/residual : 0;
+		if (step < 1) {
+			step = 1;
+		}
+
+		BIN_DATA_TYPE running = 0;
+		float scale = (total > 0) ? (float)(BIN_SIZE-1)/(float)total : 0.0f;
+		for (int j = 0; j < BIN_SIZE; j++) {
+			h[j] += share;
+			if (residual > 0 && j % step == 0) {
+				h[j]++;
+				residual--;
+			}
+			if (Luts) {
+				running += h[j];
+				int l = (int)(running*scale + 0.5f);
+				Luts[(size_t)t*BIN_SIZE + j] = (unsigned char)((l < BIN_SIZE-1) ? l : BIN_SIZE-1);
+			}
+		}
+	}
+}
+
+
+int histogram_tiled_apply(const unsigned char *In, int in_pitch, unsigned char *Out, int out_pitch,
+                          int width, int height, int tiles_x, int tiles_y, const unsigned char *Luts) {
+
+	if (!tiled_valid(width, height, in_pitch, tiles_x, tiles_y) || out_pitch < width) {
+		return -1;
+	}
+
+	float tile_w = (float)width/tiles_x;
+	float tile_h = (float)height/tiles_y;
+
+	#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		float fy = (y + 0.5f)/tile_h - 0.5f;
+		int   ty1 = (int)floorf(fy);
+		float py  = fy - ty1;
+		int   ty2 = ty1 + 1;
+		if (ty1 < 0) ty1 = 0;
+		if (ty2 > tiles_y - 1) ty2 = tiles_y - 1;
+
+		const unsigned char *in  = In  + (size_t)y*in_pitch;
+		unsigned char       *out = Out + (size_t)y*out_pitch;
+
+		for (int x = 0; x < width; x++) {
+			float fx = (x + 0.5f)/tile_w - 0.5f;
+			int   tx1 = (int)floorf(fx);
+			float px  = fx - tx1;
+			int   tx2 = tx1 + 1;
+			if (tx1 < 0) tx1 = 0;
+			if (tx2 > tiles_x - 1) tx2 = tiles_x - 1;
+
+			unsigned int v = in[x];
+			float l11 = Luts[((size_t)ty1*tiles_x + tx1)*BIN_SIZE + v];
+			float l12 = Luts[((size_t)ty1*tiles_x + tx2)*BIN_SIZE + v];
+			float l21 = Luts[((size_t)ty2*tiles_x + tx1)*BIN_SIZE + v];
+			float l22 = Luts[((size_t)ty2*tiles_x + tx2)*BIN_SIZE + v];
+			float r = (1.0f - py)*((1.0f - px)*l11 + px*l12) + py*((1.0f - px)*l21 + px*l22);
+			out[x] = (unsigned char)(r + 0.5f);
+		}
+	}
+	return 0;
+}
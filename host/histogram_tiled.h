@@ -0,0 +1,54 @@
+/* File: histogram_tiled.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_tiled.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_TILED_h__
+#define __HISTOGRAM_TILED_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Local histograms for CLAHE-style adaptive equalisation.
+//
+// The width x height image (rows pitch bytes apart) is cut into a
+// tiles_x x tiles_y grid; tile (tx, ty) covers columns
+// [tx*width/tiles_x, (tx+1)*width/tiles_x) and likewise for rows.
+// Histograms holds tiles_y*tiles_x*BIN_SIZE bins, tile by tile in row-major
+// order. All tiles are filled in one pass, threads working on tile rows.
+// Returns 0 on success, -1 for an invalid geometry.
+int histogram_tiled(const unsigned char *Image, int width, int height, int pitch,
+                    int tiles_x, int tiles_y, BIN_DATA_TYPE *Histograms);
+
+// Clips every tile histogram at clip_limit, spreads the clipped excess evenly
+// over all bins and, if Luts is not NULL, turns the clipped histogram into the
+// tile's equalisation LUT (num_tiles*BIN_SIZE entries), all in one sweep.
+void histogram_tiled_clip(BIN_DATA_TYPE *Histograms, int num_tiles, int clip_limit, unsigned char *Luts);
+
+// CLAHE remap: each pixel is mapped through the LUTs of the four nearest
+// tile centres and bilinearly interpolated. Returns -1 for an invalid geometry.
+int histogram_tiled_apply(const unsigned char *In, int in_pitch, unsigned char *Out, int out_pitch,
+                          int width, int height, int tiles_x, int tiles_y, const unsigned char *Luts);
+
+#endif // __HISTOGRAM_TILED_h__
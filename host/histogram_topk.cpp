@@ -0,0 +1,308 @@
+/* File: histogram_topk.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_topk.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_topk.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+
+int histogram_topk_create(histogram_topk_t *summary, int capacity, int sketch_width) {
+
+	if (capacity < 1 || sketch_width < 1 || (sketch_width & (sketch_width - 1)) != 0) {
+		return -1;
+	}
+	memset(summary, 0, sizeof(*summary));
+	summary->capacity = capacity;
+	summary->width    = sketch_width;
+	summary->heap     = (histogram_topk_item_t *)malloc(sizeof(histogram_topk_item_t)*capacity);
+	summary->sketch   = (uint64_t *)calloc((size_t)TOPK_SKETCH_DEPTH*sketch_width, sizeof(uint64_t));
+	// at most capacity keys, the index never exceeds half its size
+	int err = histogram_hash_create(&summary->index, 2*(size_t)capacity);
+	if (!summary->heap || !summary->sketch || err) {
+		histogram_topk_release(summary);
+		return -2;
+	}
+	return 0;
+}
+
+
+void histogram_topk_release(histogram_topk_t *summary) {
+	free(summary->heap);
+	free(summary->sketch);
+	histogram_hash_release(&summary->index);
+	summary->heap   = NULL;
+	summary->sketch = NULL;
+	summary->size   = 0;
+}
+
+
+static inline void topk_set_slot(histogram_topk_t *s, int pos) {
+	histogram_hash_slot(&s->index, s->heap[pos].key)->count = pos + 1;
+}
+
+
+static void topk_sift_down(histogram_topk_t *s, int pos) {
+	histogram_topk_item_t item = s->heap[pos];
+	for (;;) {
+		int child = 2*pos + 1;
+		if (child >= s->size) {
+			break;
+		}
+		if (child + 1 < s->size && s->heap[child+1].count < s->heap[child].count) {
+			child++;
+		}
+		if (s->heap[child].count >= item.count) {
+			break;
+		}
+		s->heap[pos] = s->heap[child];
+		topk_set_slot(s, pos);
+		pos = child;
+	}
+	s->heap[pos] = item;
+	topk_set_slot(s, pos);
+}
+
+
+static void topk_sift_up(histogram_topk_t *s, int pos) {
+	histogram_topk_item_t item = s->heap[pos];
+	while (pos > 0) {
+		int parent = (pos - 1)/2;
+		if (s->heap[parent].count <= item.count) {
+			break;
+		}
+		s->heap[pos] = s->heap[parent];
+		topk_set_slot(s, pos);
+		pos = parent;
+	}
+	s->heap[pos] = item;
+	topk_set_slot(s, pos);
+}
+
+
+static inline uint64_t topk_sketch_add(histogram_topk_t *s, uint64_t key) {
+	uint64_t h1 = histogram_hash_mix(key);
+	uint64_t h2 = histogram_hash_mix(key ^ 0x9e3779b97f4a7c15ULL) | 1;
+	uint64_t est = ~(uint64_t)0;
+	for (int r = 0; r < TOPK_SKETCH_DEPTH; r++) {
+		uint64_t *c = &s->sketch[(size_t)r*s->width + ((h1 + r*h2) & (s->width - 1))];
+		++*c;
+		est = (*c < est) ? *c : est;
+	}
+	return est;
+}
+
+
+uint64_t histogram_topk_estimate(const histogram_topk_t *summary, uint64_t key) {
+	uint64_t h1 = histogram_hash_mix(key);
+	uint64_t h2 = histogram_hash_mix(key ^ 0x9e3779b97f4a7c15ULL) | 1;
+	uint64_t est = ~(uint64_t)0;
+	for (int r = 0; r < TOPK_SKETCH_DEPTH; r++) {
+		uint64_t c = summary->sketch[(size_t)r*summary->width + ((h1 + r*h2) & (summary->width - 1))];
+		est = (c < est) ? c : est;
+	}
+	return est;
+}
+
+
+void histogram_topk_update(histogram_topk_t *summary, const uint64_t *Keys, size_t data_size) {
+
+	histogram_topk_t *s = summary;
+
+	for (size_t i = 0; i < data_size; i++) {
+		uint64_t key = Keys[i];
+		topk_sketch_add(s, key);
+
+		histogram_hash_entry_t *e = histogram_hash_slot(&s->index, key);
+		if (e->count) {
+			int pos = (int)e->count - 1;
+			s->heap[pos].count++;
+			topk_sift_down(s, pos);
+		} else if (s->size < s->capacity) {
+			e->key   = key;
+			e->count = s->size + 1;
+			s->index.size++;
+			s->heap[s->size].key   = key;
+			s->heap[s->size].count = 1;
+			s->heap[s->size].error = 0;
+			s->size++;
+			topk_sift_up(s, s->size - 1);
+		} else {
+			// Space-Saving: the new key takes over the minimum counter
+			uint64_t min = s->heap[0].count;
+			histogram_hash_remove(&s->index, s->heap[0].key);
+			e = histogram_hash_slot(&s->index, key);
+			e->key   = key;
+			e->count = 1;
+			s->index.size++;
+			s->heap[0].key   = key;
+			s->heap[0].count = min + 1;
+			s->heap[0].error = min;
+			topk_sift_down(s, 0);
+		}
+	}
+	s->total += data_size;
+}
+
+
+static bool topk_by_count(const histogram_topk_item_t &a, const histogram_topk_item_t &b) {
+	return a.count > b.count || (a.count == b.count && a.key < b.key);
+}
+
+
+int histogram_topk_merge(histogram_topk_t *dst, const histogram_topk_t *src) {
+
+	if (dst->capacity != src->capacity || dst->width != src->width) {
+		return -1;
+	}
+
+	// keys missing from a full summary may have occurred up to its minimum count
+	uint64_t dst_min = (dst->size == dst->capacity) ? dst->heap[0].count : 0;
+	uint64_t src_min = (src->size == src->capacity) ? src->heap[0].count : 0;
+	int n = dst->size + src->size;
+	histogram_topk_item_t *items = (histogram_topk_item_t *)malloc(sizeof(histogram_topk_item_t)*(n ? n : 1));
+	if (!items) {
+		return -2;
+	}
+
+	int m = 0;
+	for (int i = 0; i < dst->size; i++) {
+		items[m] = dst->heap[i];
+		uint64_t pos = histogram_hash_find(&src->index, items[m].key);
+		if (pos) {
+			items[m].count += src->heap[pos-1].count;
+			items[m].error += src->heap[pos-1].error;
+		} else {
+			items[m].count += src_min;
+			items[m].error += src_min;
+		}
+		m++;
+	}
+	for (int i = 0; i < src->size; i++) {
+		if (!histogram_hash_find(&dst->index, src->heap[i].key)) {
+			items[m] = src->heap[i];
+			items[m].count += dst_min;
+			items[m].error += dst_min;
+			m++;
+		}
+	}
+
+	std::sort(items, items + m, topk_by_count);
+	if (m > dst->capacity) {
+		m = dst->capacity;
+	}
+
+	histogram_hash_clear(&dst->index);
+	dst->size = 0;
+	for (int i = 0; i < m; i++) {
+		histogram_hash_entry_t *e = histogram_hash_slot(&dst->index, items[i].key);
+		e->key   = items[i].key;
+		e->count = dst->size + 1;
+		dst->index.size++;
+		dst->heap[dst->size++] = items[i];
+		topk_sift_up(dst, dst->size - 1);
+	}
+	free(items);
+
+	for (size_t j = 0; j < (size_t)TOPK_SKETCH_DEPTH*dst->width; j++) {
+		dst->sketch[j] += src->sketch[j];
+	}
+	dst->total += src->total;
+	return 0;
+}
+
+
+int histogram_topk(const uint64_t *Keys, size_t data_size, int capacity, int sketch_width, histogram_topk_t *result) {
+
+	int num_threads = histogram_cpu_threads();
+	histogram_topk_t *partial = (histogram_topk_t *)calloc(num_threads, sizeof(histogram_topk_t));
+	if (!partial) {
+		return -2;
+	}
+	int err = 0;
+	for (int t = 0; t < num_threads; t++) {
+		int e = histogram_topk_create(&partial[t], capacity, sketch_width);
+		err = err ? err : e;
+	}
+
+	if (err == 0) {
+		#pragma omp parallel num_threads(num_threads)
+		{
+			size_t begin, end;
+			int tid = histogram_cpu_thread_range(data_size, &begin, &end);
+			histogram_topk_update(&partial[tid], &Keys[begin], end - begin);
+		}
+		for (int t = 1; t < num_threads && err == 0; t++) {
+			err = histogram_topk_merge(&partial[0], &partial[t]);
+		}
+	}
+
+	for (int t = (err == 0) ? 1 : 0; t < num_threads; t++) {
+		histogram_topk_release(&partial[t]);
+	}
+	if (err == 0) {
+		*result = partial[0];
+	}
+	free(partial);
+	return err;
+}
+
+
+int histogram_topk_query(const histogram_topk_t *summary, int k, histogram_topk_item_t *items) {
+
+	int n = summary->size;
+	histogram_topk_item_t *all = (histogram_topk_item_t *)malloc(sizeof(histogram_topk_item_t)*(n ? n : 1));
+	if (!all) {
+		return -2;
+	}
+	for (int i = 0; i < n; i++) {
+		all[i] = summary->heap[i];
+		// both bounds are upper bounds on the frequency: keep the tighter one
+		uint64_t est = histogram_topk_estimate(summary, all[i].key);
+		if (est < all[i].count) {
+			all[i].error -= (all[i].count - est < all[i].error) ? all[i].count - est : all[i].error;
+			all[i].count  = est;
+		}
+	}
+	std::sort(all, all + n, topk_by_count);
+
+	if (k > n) {
+		k = n;
+	}
+	// any key not reported occurs at most this often: the next monitored
+	// key, or the minimum counter for keys the summary has dropped
+	uint64_t excluded = (k < n) ? all[k].count : 0;
+	if (n == summary->capacity && summary->heap[0].count > excluded) {
+		excluded = summary->heap[0].count;
+	}
+	for (int i = 0; i < k; i++) {
+		items[i] = all[i];
+		items[i].guaranteed = (all[i].count - all[i].error >= excluded);
+	}
+	free(all);
+	return k;
+}
@@ -0,0 +1,84 @@
+/* File: histogram_topk.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_topk.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_TOPK_h__
+#define __HISTOGRAM_TOPK_h__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "histogram_hash.h"
+
+// Rows of the Count-Min sketch.
+#define TOPK_SKETCH_DEPTH 4
+
+// A reported heavy hitter: the true frequency f satisfies
+// count - error <= f <= count. `guaranteed` is set when the lower bound is at
+// least the upper bound of the first key left out of the answer, i.e. the key
+// certainly belongs to the top k.
+typedef struct {
+	uint64_t key;
+	uint64_t count;
+	uint64_t error;
+	int      guaranteed;
+} histogram_topk_item_t;
+
+// Fixed-memory heavy-hitter summary: a Space-Saving summary of `capacity`
+// monitored keys (min-heap on count plus a key -> heap slot index) next to a
+// TOPK_SKETCH_DEPTH x width Count-Min sketch that tightens the upper bounds.
+// Space-Saving overestimates by at most total/capacity; the sketch by at most
+// e*total/width with probability 1 - e^-TOPK_SKETCH_DEPTH.
+// Summaries with the same capacity and width are mergeable.
+typedef struct {
+	int                    capacity;
+	int                    size;
+	histogram_topk_item_t *heap;
+	histogram_hash_t       index;      // key -> heap slot + 1
+	int                    width;      // power of two
+	uint64_t              *sketch;
+	uint64_t               total;
+} histogram_topk_t;
+
+// Returns 0 on success, -1 for invalid sizes, -2 if allocation fails.
+int histogram_topk_create(histogram_topk_t *summary, int capacity, int sketch_width);
+void histogram_topk_release(histogram_topk_t *summary);
+
+void histogram_topk_update(histogram_topk_t *summary, const uint64_t *Keys, size_t data_size);
+// dst absorbs src; both must have the same capacity and sketch width.
+// Returns 0 on success, -1 if the shapes differ, -2 if allocation fails.
+int histogram_topk_merge(histogram_topk_t *dst, const histogram_topk_t *src);
+
+// Single streaming pass: one summary per thread, merged at the end.
+// result is created by the call.
+int histogram_topk(const uint64_t *Keys, size_t data_size, int capacity, int sketch_width, histogram_topk_t *result);
+
+// The k most frequent keys by estimated count, in decreasing order.
+// Returns the number of items written (at most k and summary->size), or -2
+// if allocation fails.
+int histogram_topk_query(const histogram_topk_t *summary, int k, histogram_topk_item_t *items);
+// Count-Min upper bound of the frequency of any key.
+uint64_t histogram_topk_estimate(const histogram_topk_t *summary, uint64_t key);
+
+#endif // __HISTOGRAM_TOPK_h__
@@ -0,0 +1,131 @@
+/* File: histogram_weighted.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_weighted.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_weighted.h"
+#include "histogram_cpu.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+// Kahan-compensated accumulation of one block into sum[BIN_SIZE].
+template <typename W>
+static void weighted_block(const INPUT_DATA_TYPE *Data, const W *Weights, size_t length, double *sum, double *acc, double *comp) {
+
+	memset(acc,  0, sizeof(double)*HISTOGRAM_CPU_COPIES*BIN_SIZE);
+	memset(comp, 0, sizeof(double)*HISTOGRAM_CPU_COPIES*BIN_SIZE);
+
+	size_t i = 0;
+	for (; i + HISTOGRAM_CPU_COPIES <= length; i += HISTOGRAM_CPU_COPIES) {
+		for (int c = 0; c < HISTOGRAM_CPU_COPIES; c++) {
+			unsigned int b = c*BIN_SIZE + (unsigned int)Data[i+c];
+			double y = (double)Weights[i+c] - comp[b];
+			double t = acc[b] + y;
+			comp[b] = (t - acc[b]) - y;
+			acc[b]  = t;
+		}
+	}
+	for (int c = 0; i < length; i++, c++) {
+		unsigned int b = c*BIN_SIZE + (unsigned int)Data[i];
+		double y = (double)Weights[i] - comp[b];
+		double t = acc[b] + y;
+		comp[b] = (t - acc[b]) - y;
+		acc[b]  = t;
+	}
+
+	for (int j = 0; j < BIN_SIZE; j++) {
+		double s = 0;
+		for (int c = 0; c < HISTOGRAM_CPU_COPIES; c++) {
+			s += acc[c*BIN_SIZE + j] - comp[c*BIN_SIZE + j];
+		}
+		sum[j] = s;
+	}
+}
+
+
+template <typename W, typename B>
+static int weighted_histogram(const INPUT_DATA_TYPE *Data, const W *Weights, size_t data_size, B *Histogram) {
+
+	size_t block = HISTOGRAM_WEIGHTED_BLOCK;
+	if (data_size > block*HISTOGRAM_WEIGHTED_MAX_BLOCKS) {
+		block = (data_size + HISTOGRAM_WEIGHTED_MAX_BLOCKS - 1)/HISTOGRAM_WEIGHTED_MAX_BLOCKS;
+	}
+	long num_blocks = (long)((data_size + block - 1)/block);
+	if (num_blocks == 0) {
+		for (int j = 0; j < BIN_SIZE; j++) {
+			Histogram[j] = 0;
+		}
+		return 0;
+	}
+
+	double *partial = (double *)malloc(sizeof(double)*num_blocks*BIN_SIZE);
+	if (!partial) {
+		return -2;
+	}
+
+	#pragma omp parallel
+	{
+		double acc[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+		double comp[HISTOGRAM_CPU_COPIES*BIN_SIZE];
+
+		#pragma omp for schedule(static)
+		for (long b = 0; b < num_blocks; b++) {
+			size_t begin  = b*block;
+			size_t length = (begin + block <= data_size) ? block : data_size - begin;
+			weighted_block(&Data[begin], &Weights[begin], length, &partial[b*BIN_SIZE], acc, comp);
+		}
+
+
+		// pairwise tree over the blocks; the shape only depends on num_blocks
+		for (long stride = 1; stride < num_blocks; stride *= 2) {
+			#pragma omp for schedule(static)
+			for (long b = 0; b < num_blocks; b += 2*stride) {
+				if (b + stride < num_blocks) {
+					double *dst = &partial[b*BIN_SIZE];
+					const double *src = &partial[(b+stride)*BIN_SIZE];
+					for (int j = 0; j < BIN_SIZE; j++) {
+						dst[j] += src[j];
+					}
+				}
+			}
+		}
+	}
+
+	for (int j = 0; j < BIN_SIZE; j++) {
+		Histogram[j] = (B)partial[j];
+	}
+	free(partial);
+	return 0;
+}
+
+
+int histogram_weighted_float(const INPUT_DATA_TYPE *Data, const float *Weights, size_t data_size, float *Histogram) {
+	return weighted_histogram(Data, Weights, data_size, Histogram);
+}
+
+
+int histogram_weighted_double(const INPUT_DATA_TYPE *Data, const double *Weights, size_t data_size, double *Histogram) {
+	return weighted_histogram(Data, Weights, data_size, Histogram);
+}
@@ -0,0 +1,48 @@
+/* File: histogram_weighted.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_weighted.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_WEIGHTED_h__
+#define __HISTOGRAM_WEIGHTED_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Minimum number of elements per block, and maximum number of blocks.
+#define HISTOGRAM_WEIGHTED_BLOCK      65536
+#define HISTOGRAM_WEIGHTED_MAX_BLOCKS 4096
+
+// Weighted histograms: Histogram[Data[i]] += Weights[i] over BIN_SIZE bins.
+//
+// The input is cut into blocks whose size depends only on data_size. Each
+// block is accumulated in double with Kahan compensation into interleaved
+// sub-histograms, and the block partials are then added in a fixed pairwise
+// tree. The result is therefore bit-identical for any number of threads.
+// Do not build this file with -ffast-math, which removes the compensation.
+// Returns 0 on success, -2 if allocation fails (Histogram untouched).
+int histogram_weighted_float(const INPUT_DATA_TYPE *Data, const float *Weights, size_t data_size, float *Histogram);
+int histogram_weighted_double(const INPUT_DATA_TYPE *Data, const double *Weights, size_t data_size, double *Histogram);
+
+#endif // __HISTOGRAM_WEIGHTED_h__
@@ -0,0 +1,227 @@
+/* File: histogram_window.cpp
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_window.cpp
+* date      : 18 October 2026
+*/
+#include "histogram_window.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+int histogram_window_create(histogram_window_t *w, size_t window) {
+	if (window == 0) {
+		return -1;
+	}
+	memset(w, 0, sizeof(*w));
+	w->ring = (unsigned char *)malloc(window);
+	if (!w->ring) {
+		return -2;
+	}
+	w->window = window;
+	w->mode   = -1;
+	return 0;
+}
+
+
+void histogram_window_release(histogram_window_t *w) {
+	free(w->ring);
+	w->ring = NULL;
+}
+
+
+// Bin updates that keep the mode current: a value whose count grows past
+// the mode's takes over (the smaller one on ties); only when the mode's own
+// count drops is it left to histogram_window_mode to rescan.
+static inline void window_add(histogram_window_t *w, unsigned int a) {
+	unsigned int c = ++w->counts[a];
+	w->block_counts[a/WINDOW_BLOCK_BINS]++;
+	int m = w->mode;
+	if (m >= 0 && (c > w->counts[m] || (c == w->counts[m] && (int)a < m))) {
+		w->mode = (int)a;
+	}
+}
+
+static inline void window_sub(histogram_window_t *w, unsigned int r) {
+	w->counts[r]--;
+	w->block_counts[r/WINDOW_BLOCK_BINS]--;
+	if ((int)r == w->mode) {
+		w->mode = -1;
+	}
+}
+
+
+// Replaces ring[pos, pos+len) by samples while the window is full.
+static void window_replace(histogram_window_t *w, size_t pos, const unsigned char *samples, size_t len) {
+
+	unsigned char *old = &w->ring[pos];
+	size_t i = 0;
+
+#ifdef __SSE2__
+	// stationary signals: skip 16 samples at once when nothing changes
+	for (; i + 16 <= len; i += 16) {
+		__m128i o = _mm_loadu_si128((const __m128i *)&old[i]);
+		__m128i n = _mm_loadu_si128((const __m128i *)&samples[i]);
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(o, n)) == 0xFFFF) {
+			continue;
+		}
+		for (size_t j = i; j < i + 16; j++) {
+			unsigned int a = samples[j];
+			unsigned int r = old[j];
+			if (a != r) {
+				window_sub(w, r);
+				window_add(w, a);
+			}
+		}
+		_mm_storeu_si128((__m128i *)&old[i], n);
+	}
+#endif
+	for (; i < len; i++) {
+		unsigned int a = samples[i];
+		unsigned int r = old[i];
+		if (a != r) {
+			window_sub(w, r);
+			window_add(w, a);
+		}
+		old[i] = (unsigned char)a;
+	}
+}
+
+
+// Appends samples at ring[pos, pos+len) while the window is still filling.
+static void window_append(histogram_window_t *w, size_t pos, const unsigned char *samples, size_t len) {
+	if (w->count == 0) {
+		w->mode = samples[0];		// any bin of an empty window will do
+	}
+	for (size_t i = 0; i < len; i++) {
+		window_add(w, samples[i]);
+	}
+	memcpy(&w->ring[pos], samples, len);
+	w->count += len;
+}
+
+
+void histogram_window_push(histogram_window_t *w, const unsigned char *samples, size_t num_samples) {
+
+	// only the last `window` samples survive: rebuild from them
+	if (num_samples >= w->window) {
+		memset(w->counts, 0, sizeof(w->counts));
+		memset(w->block_counts, 0, sizeof(w->block_counts));
+		w->count = 0;
+		w->mode  = -1;
+		window_append(w, 0, &samples[num_samples - w->window], w->window);
+		w->head = 0;
+		return;
+	}
+
+	while (num_samples > 0) {
+		size_t len = w->window - w->head;
+		if (len > num_samples) {
+			len = num_samples;
+		}
+		if (w->count < w->window) {
+			size_t room = w->window - w->count;
+			if (len > room) {
+				len = room;
+			}
+			window_append(w, w->head, samples, len);
+		} else {
+			window_replace(w, w->head, samples, len);
+		}
+		w->head = (w->head + len == w->window) ? 0 : w->head + len;
+		samples     += len;
+		num_samples -= len;
+	}
+}
+
+
+unsigned int histogram_window_cdf(const histogram_window_t *w, int v) {
+	if (v < 0) {
+		return 0;
+	}
+	if (v >= BIN_SIZE - 1) {
+		return (unsigned int)w->count;
+	}
+	unsigned int sum = 0;
+	int b = v/WINDOW_BLOCK_BINS;
+	for (int k = 0; k < b; k++) {
+		sum += w->block_counts[k];
+	}
+	for (int k = b*WINDOW_BLOCK_BINS; k <= v; k++) {
+		sum += w->counts[k];
+	}
+	return sum;
+}
+
+
+int histogram_window_quantile(const histogram_window_t *w, double q) {
+	if (w->count == 0) {
+		return -1;
+	}
+	// clamp to [0, 1] before the conversion; NaN counts as 0
+	if (!(q >= 0.0)) {
+		q = 0.0;
+	}
+	if (q > 1.0) {
+		q = 1.0;
+	}
+	double target = ceil(q*(double)w->count);
+	unsigned int rank = (target < 1.0) ? 1 : (unsigned int)target;
+	if (rank > w->count) {
+		rank = (unsigned int)w->count;
+	}
+
+	unsigned int sum = 0;
+	int b = 0;
+	while (sum + w->block_counts[b] < rank) {
+		sum += w->block_counts[b];
+		b++;
+	}
+	int v = b*WINDOW_BLOCK_BINS;
+	while (sum + w->counts[v] < rank) {
+		sum += w->counts[v];
+		v++;
+	}
+	return v;
+}
+
+
+int histogram_window_mode(histogram_window_t *w) {
+	if (w->count == 0) {
+		return -1;
+	}
+	if (w->mode < 0) {
+		int best = 0;
+		for (int v = 1; v < BIN_SIZE; v++) {
+			if (w->counts[v] > w->counts[best]) {
+				best = v;
+			}
+		}
+		w->mode = best;
+	}
+	return w->mode;
+}
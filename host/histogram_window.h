@@ -0,0 +1,66 @@
+/* File: histogram_window.h
+ *
+ Copyright (c) [2016] [Mohammad Hosseinabady (mohammad@hosseinabady.com)]
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+===============================================================================
+* This file has been written at University of Bristol
+* for the ENPOWER project funded by EPSRC
+*
+* File name : histogram_window.h
+* date      : 18 October 2026
+*/
+
+#ifndef __HISTOGRAM_WINDOW_h__
+#define __HISTOGRAM_WINDOW_h__
+
+#include <stddef.h>
+#include "histogram.h"
+
+// Bins summarised by one entry of block_counts (two-level CDF).
+#define WINDOW_BLOCK_BINS 16
+#define WINDOW_BLOCKS     (BIN_SIZE/WINDOW_BLOCK_BINS)
+
+// Histogram of the last `window` samples of a stream.
+// The raw samples live in a ring buffer; a push adds the new samples and
+// subtracts the ones they evict, so the cost is O(pushed) instead of O(window).
+// Per-block counts are kept alongside the bins so that quantile and CDF
+// queries touch at most WINDOW_BLOCKS + WINDOW_BLOCK_BINS counters.
+typedef struct {
+	size_t         window;
+	size_t         count;          // samples currently in the window
+	size_t         head;           // ring slot of the next sample
+	unsigned char *ring;
+	unsigned int   counts[BIN_SIZE];
+	unsigned int   block_counts[WINDOW_BLOCKS];
+	int            mode;           // kept by the bin updates, -1 when it has to be rescanned
+} histogram_window_t;
+
+// Returns 0 on success, -1 if window is 0, -2 if allocation fails.
+int histogram_window_create(histogram_window_t *w, size_t window);
+void histogram_window_release(histogram_window_t *w);
+
+void histogram_window_push(histogram_window_t *w, const unsigned char *samples, size_t num_samples);
+
+// Number of samples in the window that are <= v.
+unsigned int histogram_window_cdf(const histogram_window_t *w, int v);
+// Smallest value v with cdf(v) >= q*count, q clamped to [0, 1] with NaN as 0
+// (-1 if empty).
+int histogram_window_quantile(const histogram_window_t *w, double q);
+// Most frequent value, the smallest one on ties (-1 if empty).
+int histogram_window_mode(histogram_window_t *w);
+
+#endif // __HISTOGRAM_WINDOW_h__